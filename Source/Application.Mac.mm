@@ -3,9 +3,14 @@
 #if defined(TARGET_OS_MAC)
 
 #import <Cocoa/Cocoa.h>
+#import <QuartzCore/QuartzCore.h>
 #include <filesystem>
 #include <condition_variable>
+#include <chrono>
+#include <map>
 #include <pthread.h>
+#include <sys/event.h>
+#include <unistd.h>
 #include "Application.h"
 #include "Window.h"
 
@@ -44,22 +49,52 @@ using namespace tk;
 
 - (void)applicationDidFinishLaunching:(NSNotification*)aNotification
 {
-    // Make the application a foreground application (else it won't receive keyboard events)
-    ProcessSerialNumber psn = {0, kCurrentProcess};
-    TransformProcessType(&psn, kProcessTransformToForegroundApplication);
-
-    // Menu
+    // 前台应用已由 NSApplicationActivationPolicyRegular 保证，不再需要 TransformProcessType
     [self setupMenu];
 }
 @end
 
+struct Watch
+{
+    CFFileDescriptorRef source;
+    WatchHandle fd;
+    uint32_t events;
+    std::function<void(WatchHandle, uint32_t)> callback;
+};
+
 bool isRunning;
 pthread_t mainThread;
 int32_t exitcode = 0;
+uint32_t watchId = 0;
+std::map<uint32_t, Watch> watches;
+
+static const short WAKE_UP_SUBTYPE = 0x121;
+
+extern void DrainTasks();
+extern void InvalidateMonitors();
+void AppWakeUp(uintptr_t thread);
 
-bool IsMainThread()
+static CFOptionFlags ToCallBackTypes(uint32_t events)
 {
-    return pthread_self() == mainThread;
+    return ((events & WATCH_READ) ? kCFFileDescriptorReadCallBack : 0) | ((events & WATCH_WRITE) ? kCFFileDescriptorWriteCallBack : 0);
+}
+
+static void WatchCallBack(CFFileDescriptorRef source, CFOptionFlags flags, void* info)
+{
+    auto it = watches.find((uint32_t)(uintptr_t)info);
+    if (it == watches.end())
+        return;
+
+    // CFFileDescriptor 的回调是一次性的，回调前重新启用，回调中可以安全地 RemoveWatch
+    CFFileDescriptorEnableCallBacks(source, ToCallBackTypes(it->second.events));
+
+    uint32_t events = ((flags & kCFFileDescriptorReadCallBack) ? WATCH_READ : 0) | ((flags & kCFFileDescriptorWriteCallBack) ? WATCH_WRITE : 0);
+    auto fd = it->second.fd;
+    auto callback = it->second.callback;
+    callback(fd, events);
+
+    // 回调在 AppWait 的等待中执行，等待只在收到 NSEvent 时返回；回调中产生的任务或更新需要循环立即处理
+    AppWakeUp(0);
 }
 
 void AppInit()
@@ -68,26 +103,77 @@ void AppInit()
 
     [NSApplication sharedApplication];
     [NSApp setActivationPolicy:NSApplicationActivationPolicyRegular];
-    [NSApp activateIgnoringOtherApps:YES];
     MainAppDelegate* delegate = [[MainAppDelegate alloc] init];
     [[NSApplication sharedApplication] setDelegate:delegate];
-    [NSApp finishLaunching];
+
+    [[NSNotificationCenter defaultCenter] addObserverForName:NSApplicationDidChangeScreenParametersNotification
+                                                      object:nil
+                                                       queue:[NSOperationQueue mainQueue]
+                                                  usingBlock:^(NSNotification* note) {
+                                                    InvalidateMonitors();
+                                                  }];
 
     isRunning = true;
 }
 
-void Application::InvokeAsync(const std::function<void()>& f)
+void AppInitBackend()
 {
-    dispatch_sync(dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
-        f();
-    });
+    // finishLaunching 会连接窗口服务器并构建菜单，推迟到第一次创建窗口
+    [NSApp finishLaunching];
+    [NSApp activateIgnoringOtherApps:YES];
 }
 
-void Application::Invoke(const std::function<void()>& f)
+void AppQueryMonitors(std::vector<Monitor>& monitors)
 {
-    dispatch_sync(dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
-        f();
-    });
+    @autoreleasepool
+    {
+        NSArray<NSScreen*>* screens = [NSScreen screens];
+        if ([screens count] == 0)
+            return;
+
+        // 第一个屏幕是菜单栏所在的主屏幕，转换为以它左上角为原点的坐标
+        CGFloat top = NSMaxY([screens[0] frame]);
+        auto toRect = [top](NSRect r) -> Rect<float>
+        {
+            return {(float)r.origin.x, (float)(top - NSMaxY(r)), (float)r.size.width, (float)r.size.height};
+        };
+
+        for (NSUInteger i = 0; i < [screens count]; i++)
+        {
+            NSScreen* screen = screens[i];
+            float refresh = 0;
+            if (@available(macOS 12.0, *))
+            {
+                refresh = (float)[screen maximumFramesPerSecond];
+            }
+            else
+            {
+                CGDirectDisplayID display = [[[screen deviceDescription] objectForKey:@"NSScreenNumber"] unsignedIntValue];
+                CGDisplayModeRef mode = CGDisplayCopyDisplayMode(display);
+                if (mode != NULL)
+                {
+                    refresh = (float)CGDisplayModeGetRefreshRate(mode);
+                    CGDisplayModeRelease(mode);
+                }
+            }
+
+            monitors.push_back({toRect([screen frame]), toRect([screen visibleFrame]), (float)[screen backingScaleFactor], refresh, i == 0});
+        }
+    }
+}
+
+bool AppWait(std::chrono::steady_clock::duration timeout)
+{
+    // 运行 RunLoop 直到有事件或超时，监视的 fd 的回调会在等待期间执行，之后投递的唤醒事件结束等待
+    @autoreleasepool
+    {
+        NSDate* date = [NSDate dateWithTimeIntervalSinceNow:std::chrono::duration<double>(timeout).count()];
+        NSEvent* event = [NSApp nextEventMatchingMask:NSEventMaskAny
+                                            untilDate:date
+                                               inMode:NSDefaultRunLoopMode
+                                              dequeue:NO];
+        return event != nil;
+    }
 }
 
 //StreamPtr Application::LoadResource(const std::string& name)
@@ -114,6 +200,72 @@ void Application::Invoke(const std::function<void()>& f)
 //    return nullptr;
 //}
 
+// NSApp 的事件只能在主线程处理，macOS 上 Application 只支持在主线程创建
+uintptr_t AppInitThread()
+{
+    return 0;
+}
+
+void AppWakeUp(uintptr_t thread)
+{
+    // 可以在任意线程调用；只投递一个空事件唤醒主线程，任务在 DrainTasks 中执行
+    @autoreleasepool
+    {
+        NSEvent* event = [NSEvent otherEventWithType:NSEventTypeApplicationDefined
+                                            location:NSZeroPoint
+                                       modifierFlags:0
+                                           timestamp:0
+                                        windowNumber:0
+                                             context:nil
+                                             subtype:WAKE_UP_SUBTYPE
+                                               data1:0
+                                               data2:0];
+        [NSApp postEvent:event atStart:NO];
+    }
+}
+
+// 带 EVFILT_USER 的 kqueue，有事件触发时可读；EV_CLEAR 使读取后自动复位
+WatchHandle AppCreateWaitHandle()
+{
+    int kq = kqueue();
+    struct kevent change;
+    EV_SET(&change, 1, EVFILT_USER, EV_ADD | EV_CLEAR, 0, 0, nullptr);
+    kevent(kq, &change, 1, nullptr, 0, nullptr);
+    return kq;
+}
+
+void AppSignalWaitHandle(WatchHandle handle)
+{
+    struct kevent change;
+    EV_SET(&change, 1, EVFILT_USER, 0, NOTE_TRIGGER, 0, nullptr);
+    kevent(handle, &change, 1, nullptr, 0, nullptr);
+}
+
+void AppResetWaitHandle(WatchHandle handle)
+{
+    struct kevent event;
+    struct timespec zero = {};
+    while (kevent(handle, nullptr, 0, &event, 1, &zero) > 0)
+    {
+    }
+}
+
+void AppCloseWaitHandle(WatchHandle handle)
+{
+    close(handle);
+}
+
+void AppShowWindows(const std::vector<Window*>& windows)
+{
+    // 在同一个事务中显示，窗口服务器一次性合成所有窗口；最后激活第一个窗口
+    [CATransaction begin];
+    [CATransaction setDisableActions:YES];
+    for (auto it = windows.rbegin(); it != windows.rend(); ++it)
+        [(NSWindow*)(*it)->GetHandle() orderFront:nil];
+    [(NSWindow*)windows.front()->GetHandle() makeKeyWindow];
+    [CATransaction commit];
+}
+
 bool Application::Update()
 {
     @autoreleasepool
@@ -126,6 +278,9 @@ bool Application::Update()
                                                   dequeue:YES];
             if (event)
             {
+                if ([event type] == NSEventTypeApplicationDefined && [event subtype] == WAKE_UP_SUBTYPE)
+                    continue;
+
                 [NSApp sendEvent:event];
             }
             else
@@ -135,6 +290,8 @@ bool Application::Update()
         } while (true);
     }
 
+    DrainTasks();
+
     return isRunning;
 }
 
@@ -142,5 +299,38 @@ void Application::Exit()
 {
     isRunning = false;
 }
+
+uint32_t Application::AddWatch(WatchHandle handle, uint32_t events, const std::function<void(WatchHandle, uint32_t)>& callback)
+{
+    if (handle < 0 || ToCallBackTypes(events) == 0)
+        return 0;
+
+    watchId++;
+
+    CFFileDescriptorContext context = {0, (void*)(uintptr_t)watchId, NULL, NULL, NULL};
+    CFFileDescriptorRef source = CFFileDescriptorCreate(kCFAllocatorDefault, handle, false, WatchCallBack, &context);
+    if (source == NULL)
+        return 0;
+
+    CFFileDescriptorEnableCallBacks(source, ToCallBackTypes(events));
+    CFRunLoopSourceRef loopSource = CFFileDescriptorCreateRunLoopSource(kCFAllocatorDefault, source, 0);
+    CFRunLoopAddSource(CFRunLoopGetMain(), loopSource, kCFRunLoopCommonModes);
+    CFRelease(loopSource);
+
+    watches.emplace(watchId, Watch{source, handle, events, callback});
+    return watchId;
+}
+
+bool Application::RemoveWatch(uint32_t id)
+{
+    auto it = watches.find(id);
+    if (it == watches.end())
+        return false;
+
+    CFFileDescriptorInvalidate(it->second.source);
+    CFRelease(it->second.source);
+    watches.erase(it);
+    return true;
+}
 #endif
 #endif
\ No newline at end of file
@@ -1,77 +1,183 @@
 ﻿#ifdef _WIN32
 #include <ShellScalingApi.h>
 #include <condition_variable>
+#include <algorithm>
+#include <chrono>
+#include <map>
 #include "Application.h"
 #include "Window.h"
 
 using namespace tk;
 
-DWORD mainThread;
+struct Watch
+{
+    HANDLE handle;
+    uint32_t events;
+    std::function<void(WatchHandle, uint32_t)> callback;
+};
+
+// 监视的句柄属于调用 AddWatch 的线程的消息循环
+thread_local uint32_t watchId = 0;
+thread_local std::map<uint32_t, Watch> watches;
 
 static const UINT WM_INVOKE = WM_USER + 0x121;
 
-bool IsMainThread()
+#ifndef CREATE_WAITABLE_TIMER_HIGH_RESOLUTION
+#define CREATE_WAITABLE_TIMER_HIGH_RESOLUTION 0x00000002
+#endif
+
+// 毫秒超时受系统时钟粒度限制，可能晚到十几毫秒；等待时加入高精度计时器，系统不支持时退回毫秒超时
+struct WaitTimer
 {
-    return GetCurrentThreadId() == mainThread;
-}
+    HANDLE handle = CreateWaitableTimerExW(NULL, NULL, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS);
+
+    ~WaitTimer()
+    {
+        if (handle != NULL)
+            CloseHandle(handle);
+    }
+};
+
+static thread_local WaitTimer waitTimer;
+
+extern void DrainTasks();
 
 void AppInit()
 {
-    mainThread = GetCurrentThreadId();
+}
+
+uintptr_t AppInitThread()
+{
+    // 线程第一次调用消息函数时才创建消息队列，在此之前 PostThreadMessage 会失败
+    MSG msg;
+    PeekMessage(&msg, NULL, WM_USER, WM_USER, PM_NOREMOVE);
+    return GetCurrentThreadId();
+}
 
-    // EnableHiDPI
-    do
+void AppInitBackend()
+{
+    // EnableHiDPI，必须在创建第一个窗口之前设置
+    // user32 总是已经加载，用 GetModuleHandle 避免 LoadLibrary 的加载器锁和引用计数开销
+    auto user32 = GetModuleHandle(TEXT("user32.dll"));
+    if (user32 != NULL)
     {
-        auto user32 = LoadLibrary(TEXT("user32.dll"));
-        if (user32 != NULL)
+        auto proc = GetProcAddress(user32, "SetProcessDpiAwarenessContext");
+        if (proc != nullptr)
         {
-            auto proc = GetProcAddress(user32, "SetProcessDpiAwarenessContext");
-            if (proc != nullptr)
-            {
-                ((std::add_pointer_t<decltype(SetProcessDpiAwarenessContext)>)proc)(DPI_AWARENESS_CONTEXT_PER_MONITOR_AWARE_V2); // Windows 10，版本1607以上
-            }
-            FreeLibrary(user32);
-            break;
+            ((std::add_pointer_t<decltype(SetProcessDpiAwarenessContext)>)proc)(DPI_AWARENESS_CONTEXT_PER_MONITOR_AWARE_V2); // Windows 10，版本1607以上
+            return;
         }
+    }
 
-        auto shcore = LoadLibrary(TEXT("shcore.dll"));
-        if (shcore != nullptr)
+    auto shcore = LoadLibrary(TEXT("shcore.dll"));
+    if (shcore != nullptr)
+    {
+        auto proc = GetProcAddress(shcore, "SetProcessDpiAwareness");
+        if (proc != nullptr)
         {
-            auto proc = GetProcAddress(shcore, "SetProcessDpiAwareness");
-            if (proc != nullptr)
-            {
-                ((std::add_pointer_t<decltype(SetProcessDpiAwareness)>)proc)(PROCESS_PER_MONITOR_DPI_AWARE); // Windows 8.1以上
-            }
-            FreeLibrary(shcore);
-            break;
+            ((std::add_pointer_t<decltype(SetProcessDpiAwareness)>)proc)(PROCESS_PER_MONITOR_DPI_AWARE); // Windows 8.1以上
         }
+        FreeLibrary(shcore);
+        if (proc != nullptr)
+            return;
+    }
+
+    SetProcessDPIAware(); // Windows Vista
+}
+
+static BOOL CALLBACK EnumMonitorProc(HMONITOR monitor, HDC, LPRECT, LPARAM data)
+{
+    MONITORINFOEX info;
+    info.cbSize = sizeof(info);
+    if (!GetMonitorInfo(monitor, &info))
+        return TRUE;
 
-        SetProcessDPIAware(); // Windows Vista
-    } while (false);
+    UINT dpiX = USER_DEFAULT_SCREEN_DPI, dpiY = USER_DEFAULT_SCREEN_DPI;
+    GetDpiForMonitor(monitor, MDT_EFFECTIVE_DPI, &dpiX, &dpiY);
+    float scale = dpiX / (float)USER_DEFAULT_SCREEN_DPI;
+
+    DEVMODE mode;
+    ZeroMemory(&mode, sizeof(mode));
+    mode.dmSize = sizeof(mode);
+    float refresh = 0;
+    if (EnumDisplaySettings(info.szDevice, ENUM_CURRENT_SETTINGS, &mode) && mode.dmDisplayFrequency > 1)
+        refresh = (float)mode.dmDisplayFrequency; // 0 和 1 表示硬件默认值
+
+    auto toRect = [scale](const RECT& r) -> Rect<float>
+    {
+        return {r.left / scale, r.top / scale, (r.right - r.left) / scale, (r.bottom - r.top) / scale};
+    };
+
+    auto monitors = (std::vector<Monitor>*)data;
+    monitors->push_back({toRect(info.rcMonitor), toRect(info.rcWork), scale, refresh, (info.dwFlags & MONITORINFOF_PRIMARY) != 0});
+    return TRUE;
 }
 
-void Application::InvokeAsync(const std::function<void()>& f)
+void AppQueryMonitors(std::vector<Monitor>& monitors)
 {
-    PostThreadMessage(mainThread, WM_INVOKE, (WPARAM) new std::function<void()>(f), TRUE);
+    EnumDisplayMonitors(NULL, NULL, EnumMonitorProc, (LPARAM)&monitors);
 }
 
-void Application::Invoke(const std::function<void()>& f)
+bool AppWait(std::chrono::steady_clock::duration timeout)
 {
-    if (IsMainThread())
+    // MsgWaitForMultipleObjectsEx 最多等待 MAXIMUM_WAIT_OBJECTS - 1 个句柄，最后一个位置留给计时器
+    HANDLE handles[MAXIMUM_WAIT_OBJECTS - 1];
+    uint32_t ids[MAXIMUM_WAIT_OBJECTS - 2];
+    DWORD count = 0;
+    for (auto&& it : watches)
+    {
+        if (count == MAXIMUM_WAIT_OBJECTS - 2)
+            break;
+
+        ids[count] = it.first;
+        handles[count++] = it.second.handle;
+    }
+
+    auto ms = std::chrono::ceil<std::chrono::milliseconds>(timeout).count();
+    DWORD wait = (DWORD)std::min<int64_t>(ms, INFINITE - 1);
+    DWORD total = count;
+    if (waitTimer.handle != NULL && ms < INFINITE - 1)
     {
-        f();
+        // 相对时间，以 100 纳秒为单位的负数
+        LARGE_INTEGER due;
+        due.QuadPart = -(std::max)((int64_t)(std::chrono::duration_cast<std::chrono::nanoseconds>(timeout).count() / 100), (int64_t)1);
+        if (SetWaitableTimer(waitTimer.handle, &due, 0, NULL, NULL, FALSE))
+        {
+            handles[total++] = waitTimer.handle;
+            wait = INFINITE;
+        }
     }
-    else
+
+    DWORD ret = MsgWaitForMultipleObjectsEx(total, handles, wait, QS_ALLINPUT, MWMO_INPUTAVAILABLE);
+    if (total > count)
     {
-        std::mutex g_lockqueue;
-        std::unique_lock<std::mutex> locker(g_lockqueue);
-        std::condition_variable g_queuecheck;
-        InvokeAsync([&]()
-                    {
-            f();
-            g_queuecheck.notify_one(); });
-        g_queuecheck.wait(locker);
+        if (ret == WAIT_OBJECT_0 + count)
+            return false;
+
+        CancelWaitableTimer(waitTimer.handle);
     }
+
+    if (ret == WAIT_TIMEOUT || ret == WAIT_FAILED)
+        return false;
+
+    if (ret >= WAIT_OBJECT_0 && ret < WAIT_OBJECT_0 + count)
+    {
+        // 只返回了下标最小的句柄，其余已就绪的句柄也在这里一起处理
+        for (DWORD i = ret - WAIT_OBJECT_0; i < count; i++)
+        {
+            if (i != ret - WAIT_OBJECT_0 && WaitForSingleObject(handles[i], 0) != WAIT_OBJECT_0)
+                continue;
+
+            auto it = watches.find(ids[i]);
+            if (it == watches.end())
+                continue;
+
+            auto callback = it->second.callback;
+            callback(handles[i], it->second.events);
+        }
+    }
+
+    return true;
 }
 
 //rtti::StreamPtr Application::LoadResource(int32_t id)
@@ -88,6 +194,41 @@ void Application::Invoke(const std::function<void()>& f)
 //    return nullptr;
 //}
 
+void AppWakeUp(uintptr_t thread)
+{
+    PostThreadMessage((DWORD)thread, WM_INVOKE, 0, 0);
+}
+
+// 手动复位的事件，由 ProcessPending 在处理之前复位
+WatchHandle AppCreateWaitHandle()
+{
+    return CreateEvent(NULL, TRUE, FALSE, NULL);
+}
+
+void AppSignalWaitHandle(WatchHandle handle)
+{
+    SetEvent((HANDLE)handle);
+}
+
+void AppResetWaitHandle(WatchHandle handle)
+{
+    ResetEvent((HANDLE)handle);
+}
+
+void AppCloseWaitHandle(WatchHandle handle)
+{
+    CloseHandle((HANDLE)handle);
+}
+
+void AppShowWindows(const std::vector<Window*>& windows)
+{
+    // 不像 ShowImpl 那样逐个同步绘制，WM_PAINT 在消息循环中一起处理；最后激活第一个窗口
+    for (auto win : windows)
+        ShowWindow((HWND)win->GetHandle(), SW_SHOWNOACTIVATE);
+
+    SetForegroundWindow((HWND)windows.front()->GetHandle());
+}
+
 bool Application::Update()
 {
     MSG msg;
@@ -95,24 +236,16 @@ bool Application::Update()
 
     while (PeekMessage(&msg, NULL, 0U, 0U, PM_REMOVE))
     {
+        // WM_INVOKE 只用于唤醒，任务在 DrainTasks 中执行
         if (msg.message == WM_INVOKE)
-        {
-            auto f = (std::function<void()>*)msg.wParam;
-            if (f != nullptr)
-            {
-                (*f)();
-                
-                delete f;
-                f = nullptr;
-            }
-        }
-        else
-        {
-            TranslateMessage(&msg);
-            DispatchMessage(&msg);
-        }
+            continue;
+
+        TranslateMessage(&msg);
+        DispatchMessage(&msg);
     }
 
+    DrainTasks();
+
     return msg.message != WM_QUIT;
 }
 
@@ -121,4 +254,19 @@ void Application::Exit()
     PostQuitMessage(0);
 }
 
+uint32_t Application::AddWatch(WatchHandle handle, uint32_t events, const std::function<void(WatchHandle, uint32_t)>& callback)
+{
+    if (handle == NULL || handle == INVALID_HANDLE_VALUE || watches.size() >= MAXIMUM_WAIT_OBJECTS - 2)
+        return 0;
+
+    watchId++;
+    watches.emplace(watchId, Watch{(HANDLE)handle, events, callback});
+    return watchId;
+}
+
+bool Application::RemoveWatch(uint32_t id)
+{
+    return watches.erase(id) != 0;
+}
+
 #endif
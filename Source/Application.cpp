@@ -1,99 +1,875 @@
 ﻿#include <condition_variable>
+#include <cstdio>
+#include <algorithm>
+#include <atomic>
 #include <chrono>
+#include <list>
+#include <memory_resource>
+#include <mutex>
 #include <thread>
+#include <vector>
 #include "Application.h"
 #include "Window.h"
+#include "Gamepad.h"
+#include "TimerWheel.h"
+#include "Watchdog.h"
 
 using namespace tk;
 
-Application* app = nullptr;
-Window* mainWindow = nullptr;
-std::map<Window*, std::function<void()>> windows;
+namespace tk
+{
+void DispatchEvent(Window* win, Event* e);
+void UpdateWindow(Window* win, std::chrono::steady_clock::duration delta);
+}
+
+using Clock = TimerWheel::Clock;
+
+constexpr auto FRAME_INTERVAL = UPDATE_INTERVAL;
+constexpr size_t FRAME_ARENA_SIZE = 64 * 1024;
+constexpr size_t NESTED_FRAME_ARENA_SIZE = 4 * 1024;
+
+// 统计向系统堆申请内存的次数，用于观察稳态下每帧的分配
+class CountingResource : public std::pmr::memory_resource
+{
+public:
+    uint64_t GetCount() const { return count.load(std::memory_order_relaxed); }
+
+private:
+    void* do_allocate(size_t bytes, size_t alignment) override
+    {
+        count.fetch_add(1, std::memory_order_relaxed);
+        return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+    }
+
+    void do_deallocate(void* p, size_t bytes, size_t alignment) override
+    {
+        std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override
+    {
+        return this == &other;
+    }
+
+    std::atomic<uint64_t> count = 0;
+};
+
+CountingResource& GetCountingResource()
+{
+    static CountingResource resource;
+    return resource;
+}
+
+std::pmr::memory_resource* GetListenerResource()
+{
+    // 多个 UI 线程会同时创建窗口，使用带锁的池
+    static std::pmr::synchronized_pool_resource pool(&GetCountingResource());
+    return &pool;
+}
+
+std::pmr::memory_resource* GetTaskResource()
+{
+    static std::pmr::synchronized_pool_resource pool(&GetCountingResource());
+    return &pool;
+}
+
+// 任意线程投递的窗口命令
+std::pmr::memory_resource* GetCommandResource()
+{
+    static std::pmr::synchronized_pool_resource pool(&GetCountingResource());
+    return &pool;
+}
 
-extern bool IsMainThread();
 extern void AppInit();
+extern uintptr_t AppInitThread();
+extern void AppInitBackend();
 extern void AppUnInit();
+extern bool AppWait(Clock::duration timeout);
+extern void AppWakeUp(uintptr_t thread);
+extern void AppQueryMonitors(std::vector<Monitor>& monitors);
+extern void PollGamepads();
+extern void FlushAllTextInput();
+extern void AppShowWindows(const std::vector<Window*>& windows);
+extern WatchHandle AppCreateWaitHandle();
+extern void AppSignalWaitHandle(WatchHandle handle);
+extern void AppResetWaitHandle(WatchHandle handle);
+extern void AppCloseWaitHandle(WatchHandle handle);
+extern uintptr_t WatchdogOpenThread();
+extern void ClipboardBackendRelease();
+
+namespace tk
+{
+void ReplayWindowCommands(Window* win);
+}
+
+namespace tk
+{
+struct WindowEntry
+{
+    Clock::time_point nextUpdate = Clock::time_point::max();
+    Clock::time_point lastUpdate = {};
+    Clock::duration interval = FRAME_INTERVAL; // 按更新策略计算的实际间隔
+    uint64_t generation = 0;                   // 与堆中的节点比较，不一致说明节点已作废
+    bool limited = false;                      // 间隔被更新策略延长或暂停
+    bool requested = false;
+};
+
+// 按时间排列的最小堆节点；重新安排时不从堆中删除旧节点，出堆时按 generation 丢弃
+struct UpdateDeadline
+{
+    Clock::time_point time;
+    Window* window;
+    uint64_t generation;
+
+    bool operator>(const UpdateDeadline& other) const { return time > other.time; }
+};
+
+// 每个运行 Application 的线程拥有独立的窗口表、任务队列、定时器和帧内存，窗口绑定在创建它的线程上
+struct LoopContext
+{
+    Application* app = nullptr;
+    Window* mainWindow = nullptr;
+    std::map<Window*, WindowEntry> windows;
+    std::vector<UpdateDeadline> deadlines;
+    uint64_t deadlineGeneration = 0;
+    std::vector<Window*> limitedWindows; // 状态变化没有事件通知，每次循环检查一次
+    TimerWheel timers;
+    uintptr_t thread = 0; // 后端用于唤醒该线程的标识
+
+    alignas(std::max_align_t) std::byte frameBuffer[FRAME_ARENA_SIZE];
+    std::pmr::monotonic_buffer_resource frameArena{frameBuffer, sizeof(frameBuffer), &GetCountingResource()};
+    std::pmr::memory_resource* frameResource = &frameArena; // 当前这一层循环迭代使用的临时内存
+    int32_t loopDepth = 0;
+    uint64_t frameAllocations = 0;
+
+    std::mutex taskLock;
+    std::pmr::list<std::function<void()>> tasks{GetTaskResource()};
+
+    std::vector<Monitor> monitors;
+    bool monitorsValid = false;
+    bool monitorsChangedPending = false;
+
+    std::atomic<bool> commandsPending = false; // 其他线程向本线程的窗口提交了命令
+    std::atomic<bool> waiting = false;         // 正在 AppWait 中，只有这时才需要唤醒
+    bool creatingWindows = false;              // 在 CreateWindows 中，后端推迟显示
+
+    // RunLoop 与 ProcessPending 共用的循环状态
+    Clock::time_point nextFrame = {};
+    uint64_t allocations = 0;
+    Clock::duration frameWork{};
+
+    // 由 GetWaitHandle 创建，其他线程在设置 hasWaitHandle 之后才会使用
+    WatchHandle waitHandle{};
+    std::atomic<bool> hasWaitHandle = false;
+
+    FrameStatsRecorder stats;
+
+    // 心跳每次循环只写一次，开启监视后由 watchdog 读取；watchdog 在 waiting 和 activity 之前析构
+    WatchdogActivity activity;
+    uint64_t iterations = 0;
+    std::unique_ptr<Watchdog> watchdog;
+
+    ~LoopContext()
+    {
+        if (hasWaitHandle.load())
+            AppCloseWaitHandle(waitHandle);
+    }
+};
+} // namespace tk
+
+thread_local LoopContext* currentContext = nullptr;
+std::atomic<int32_t> applicationCount = 0;
+
+std::mutex startupLock;
+std::once_flag backendOnce;
+Clock::time_point startupBegin;
+StartupTimings startup = {};
+
+static void ScheduleWindow(Window* win, WindowEntry& entry, Clock::time_point time)
+{
+    auto& heap = currentContext->deadlines;
+    entry.nextUpdate = time;
+    entry.generation = ++currentContext->deadlineGeneration;
+    if (time == Clock::time_point::max())
+        return;
+
+    heap.push_back({time, win, entry.generation});
+    std::push_heap(heap.begin(), heap.end(), std::greater<>());
+
+    // 作废的节点过多时重建，避免频繁改变间隔的窗口让堆无限增长
+    if (heap.size() > currentContext->windows.size() * 2 + 64)
+    {
+        heap.clear();
+        for (auto&& it : currentContext->windows)
+        {
+            if (it.second.nextUpdate != Clock::time_point::max())
+                heap.push_back({it.second.nextUpdate, it.first, it.second.generation});
+        }
+        std::make_heap(heap.begin(), heap.end(), std::greater<>());
+    }
+}
+
+static void UpdateInterval(Window* win, WindowEntry& entry)
+{
+    entry.interval = win->GetEffectiveUpdateInterval();
+    bool limited = entry.interval != win->GetUpdateInterval();
+    if (limited && !entry.limited)
+        currentContext->limitedWindows.push_back(win);
+    entry.limited = limited;
+}
+
+static Clock::time_point GetDueTime(const WindowEntry& entry, Clock::time_point now)
+{
+    if (entry.limited && entry.interval == Clock::duration::max())
+        return Clock::time_point::max();
+    if (entry.requested || entry.lastUpdate == Clock::time_point{})
+        return now;
+    if (entry.interval == Clock::duration::max())
+        return Clock::time_point::max();
+
+    return (std::max)(entry.lastUpdate + entry.interval, now);
+}
+
+static void EvaluateWindow(Window* win, WindowEntry& entry, Clock::time_point now)
+{
+    UpdateInterval(win, entry);
+    auto due = GetDueTime(entry, now);
+    if (due != entry.nextUpdate)
+        ScheduleWindow(win, entry, due);
+}
 
-bool UpdateAllWindows(Application* app)
+// 调用到期窗口的 OnUpdate；next 返回最早的下次更新时间，所有窗口都暂停时为 time_point::max()
+// missed 返回到期窗口中按各自间隔落后最多的帧数
+bool UpdateAllWindows(Application* app, Clock::time_point now, Clock::time_point& next, bool& updated, uint64_t& missed)
 {
+    next = Clock::time_point::max();
+    updated = false;
+    missed = 0;
+
+    auto& windows = currentContext->windows;
     if (windows.size() == 0)
         return false;
 
-    if (mainWindow != nullptr && windows.find(mainWindow) == windows.end())
+    if (currentContext->mainWindow != nullptr && windows.find(currentContext->mainWindow) == windows.end())
     {
         app->Exit();
         return false;
     }
 
-    auto wins = windows;
+    // 受策略限制的窗口每次循环都重新检查，状态解除后立即恢复；仍受限的窗口会重新加入列表
+    auto& limited = currentContext->limitedWindows;
+    size_t count = limited.size();
+    for (size_t i = 0; i < count; i++)
+    {
+        auto win = limited[i];
+        auto it = windows.find(win);
+        if (it == windows.end() || !it->second.limited)
+            continue;
 
-    for (auto&& it : wins)
+        it->second.limited = false;
+        EvaluateWindow(win, it->second, now);
+    }
+    limited.erase(limited.begin(), limited.begin() + count);
+
+    // 先取出所有到期的节点；OnUpdate 中可能关闭窗口或重新安排其他窗口，所以调用前重新查找
+    auto& heap = currentContext->deadlines;
+    std::pmr::vector<UpdateDeadline> due(currentContext->frameResource);
+    while (!heap.empty() && heap.front().time <= now)
     {
-        it.second();
+        std::pop_heap(heap.begin(), heap.end(), std::greater<>());
+        due.push_back(heap.back());
+        heap.pop_back();
+    }
+
+    for (auto&& deadline : due)
+    {
+        auto it = windows.find(deadline.window);
+        if (it == windows.end() || it->second.generation != deadline.generation)
+            continue;
+
+        // 正常频率的窗口在到期时才检查更新策略
+        auto win = deadline.window;
+        auto& entry = it->second;
+        UpdateInterval(win, entry);
+        auto time = GetDueTime(entry, now);
+        if (time > now)
+        {
+            ScheduleWindow(win, entry, time);
+            continue;
+        }
+
+        auto delta = entry.lastUpdate == Clock::time_point{} ? Clock::duration::zero() : now - entry.lastUpdate;
+        entry.lastUpdate = now;
+        entry.requested = false;
+
+        // 按计划时间推进以免累积误差，落后超过一个间隔时不补帧
+        auto nextUpdate = Clock::time_point::max();
+        if (entry.interval != Clock::duration::max())
+        {
+            if (now - deadline.time >= entry.interval)
+                missed = (std::max)(missed, (uint64_t)((now - deadline.time) / entry.interval));
+
+            nextUpdate = deadline.time + entry.interval;
+            if (nextUpdate <= now)
+                nextUpdate = now + entry.interval;
+        }
+        ScheduleWindow(win, entry, nextUpdate);
+
+        UpdateWindow(win, delta);
+        updated = true;
+    }
+
+    // 丢弃堆顶作废的节点，避免为它们提前醒来
+    while (!heap.empty())
+    {
+        auto& top = heap.front();
+        auto it = windows.find(top.window);
+        if (it != windows.end() && it->second.generation == top.generation)
+        {
+            next = top.time;
+            break;
+        }
+
+        std::pop_heap(heap.begin(), heap.end(), std::greater<>());
+        heap.pop_back();
     }
 
     return true;
 }
-void RunLoop(Application* app, Window* win)
+// 先标记再检查队列，与 WakeUp 的先入队再检查标记配对：投递方要么看到标记并唤醒，要么任务在这里被发现
+static bool WaitForWork(Clock::duration timeout)
 {
-    while (true)
+    auto& context = *currentContext;
+    context.waiting.store(true);
+
+    bool pending;
     {
-        auto begin = std::chrono::high_resolution_clock::now();
-        if (!app->Update())
-            break;
+        std::lock_guard<std::mutex> lock(context.taskLock);
+        pending = !context.tasks.empty();
+    }
 
-        if (win != nullptr && windows.find(win) == windows.end())
-            break;
+    bool woken = pending || context.commandsPending.load() || AppWait(timeout);
+    context.waiting.store(false);
+    return woken;
+}
+// 等待窗口消息、被监视的句柄或 deadline 到达；精度由后端的等待决定，不忙等
+void WaitUntil(Clock::time_point deadline)
+{
+    auto now = Clock::now();
+    if (deadline > now)
+        WaitForWork(deadline - now);
+}
+// 目标线程醒着时会在下一次等待之前看到任务或命令，不发送唤醒消息；外部循环的句柄总是需要置位
+static void WakeUp(LoopContext* target)
+{
+    if (target->waiting.load())
+        AppWakeUp(target->thread);
+    if (target->hasWaitHandle.load(std::memory_order_acquire))
+        AppSignalWaitHandle(target->waitHandle);
+}
+static void PostTask(LoopContext* target, const std::function<void()>& f)
+{
+    bool wake;
+    {
+        std::lock_guard<std::mutex> lock(target->taskLock);
+        wake = target->tasks.empty();
+        target->tasks.push_back(f);
+    }
 
-        if (!UpdateAllWindows(app))
-            break;
+    // 队列非空时目标线程一定已被唤醒过，不必重复唤醒
+    if (wake)
+        WakeUp(target);
+}
+void PostTask(const std::function<void()>& f)
+{
+    PostTask(currentContext, f);
+}
+static void ReplayAllWindowCommands()
+{
+    if (!currentContext->commandsPending.exchange(false, std::memory_order_acquire))
+        return;
+
+    std::pmr::vector<Window*> wins(currentContext->frameResource);
+    wins.reserve(currentContext->windows.size());
+    for (auto&& it : currentContext->windows)
+        wins.push_back(it.first);
+
+    for (auto win : wins)
+    {
+        if (currentContext->windows.find(win) != currentContext->windows.end())
+            ReplayWindowCommands(win);
+    }
+}
+LoopContext* GetLoopContext()
+{
+    return currentContext;
+}
+void WakeLoopContext(LoopContext* context)
+{
+    context->commandsPending.store(true);
+    WakeUp(context);
+}
+void DrainTasks()
+{
+    if (currentContext == nullptr)
+        return;
+
+    std::pmr::list<std::function<void()>> pending(GetTaskResource());
+    {
+        std::lock_guard<std::mutex> lock(currentContext->taskLock);
+        pending.splice(pending.end(), currentContext->tasks);
+    }
+
+    size_t count = 0;
+    for (auto&& f : pending)
+    {
+        f();
+        count++;
+    }
+    currentContext->stats.AddTasks(count);
+}
+// 一次循环中除等待以外的部分，返回 false 时结束循环
+static bool RunFrame(Application* app, Window* win)
+{
+    auto& context = *currentContext;
+    auto& stats = context.stats;
+
+    // 计数是进程级的，多个 UI 线程时包含其他线程的分配
+    auto count = GetCountingResource().GetCount();
+    context.frameAllocations = count - context.allocations;
+    context.allocations = count;
+
+    context.activity.heartbeat.store(++context.iterations * 2, std::memory_order_relaxed);
+
+    auto begin = Clock::now();
+    ReplayAllWindowCommands();
+
+    if (!app->Update())
+        return false;
+
+    FlushAllTextInput();
+
+    PollGamepads();
+
+    if (win != nullptr && context.windows.find(win) == context.windows.end())
+        return false;
+
+    context.timers.Advance(Clock::now());
+
+    auto updated = Clock::now();
+    stats.AddUpdateTime(updated - begin);
+    context.frameWork += updated - begin;
+
+    bool frame = false;
+    uint64_t missed = 0;
+    if (!UpdateAllWindows(app, updated, context.nextFrame, frame, missed))
+        return false;
+
+    if (frame)
+    {
+        if (missed > 0)
+            stats.AddMissedFrames(missed);
 
-        auto end = std::chrono::high_resolution_clock::now();
+        auto end = Clock::now();
+        stats.AddOnUpdateTime(end - updated);
+        stats.RecordFrame(context.frameWork + (end - updated));
+        context.frameWork = Clock::duration::zero();
+    }
+
+    return true;
+}
+static bool RunOnce(Application* app, Window* win)
+{
+    auto& context = *currentContext;
+    if (context.loopDepth == 1)
+    {
+        context.frameArena.release();
+        return RunFrame(app, win);
+    }
+
+    // 嵌套的 RunLoop（如 ShowDialog）不能释放外层帧仍在使用的内存，每次迭代改用自己的区域，迭代结束后整体丢弃
+    alignas(std::max_align_t) std::byte buffer[NESTED_FRAME_ARENA_SIZE];
+    std::pmr::monotonic_buffer_resource arena(buffer, sizeof(buffer), &GetCountingResource());
+    auto outer = context.frameResource;
+    context.frameResource = &arena;
+    bool running = RunFrame(app, win);
+    context.frameResource = outer;
+    return running;
+}
+void RunLoop(Application* app, Window* win)
+{
+    auto& stats = currentContext->stats;
+    currentContext->nextFrame = Clock::now();
+    currentContext->allocations = GetCountingResource().GetCount();
+    currentContext->frameWork = Clock::duration::zero();
 
-        auto dt = std::chrono::duration_cast<std::chrono::milliseconds>(end - begin);
-        if (dt.count() < 33)
-            std::this_thread::sleep_for(std::chrono::milliseconds(33) - dt);
+    currentContext->loopDepth++;
+    while (RunOnce(app, win))
+    {
+        auto nextFrame = currentContext->nextFrame;
+        auto timer = currentContext->timers.NextDeadline();
+        auto deadline = (std::min)(nextFrame, timer);
+        auto sleep = Clock::now();
+        if (deadline > sleep)
+        {
+            WaitUntil(deadline);
+            stats.AddSleepTime(Clock::now() - sleep);
+            stats.AddWakeUp();
+        }
     }
+    currentContext->loopDepth--;
 }
-void RegisterWindow(Window* win, const std::function<void()>& updater)
+bool IsCreatingWindows()
 {
-    windows.emplace(win, updater);
+    return currentContext != nullptr && currentContext->creatingWindows;
+}
+void RegisterWindow(Window* win)
+{
+    if (currentContext == nullptr)
+        return;
+
+    auto it = currentContext->windows.emplace(win, WindowEntry{}).first;
+    ScheduleWindow(win, it->second, Clock::now());
+}
+// 更新间隔、更新策略改变或请求更新时调用，只能在窗口所属线程调用
+void RescheduleWindow(Window* win, bool request)
+{
+    if (currentContext == nullptr)
+        return;
+
+    auto it = currentContext->windows.find(win);
+    if (it == currentContext->windows.end())
+        return;
+
+    it->second.requested |= request;
+    EvaluateWindow(win, it->second, Clock::now());
 }
 void UnRegisterWindow(Window* win)
 {
-    auto it = windows.find(win);
-    if (it != windows.end())
-        windows.erase(it);
+    if (currentContext == nullptr)
+        return;
+
+    auto it = currentContext->windows.find(win);
+    if (it != currentContext->windows.end())
+        currentContext->windows.erase(it);
+}
+// 窗口后端在第一次创建窗口时才初始化，只打开消息循环或定时器的程序不需要付出这部分开销
+void EnsureBackend()
+{
+    std::call_once(backendOnce, []()
+                   {
+        auto begin = Clock::now();
+        AppInitBackend();
+        std::lock_guard<std::mutex> lock(startupLock);
+        startup.Backend = Clock::now() - begin; });
+}
+void RecordFirstWindow()
+{
+    std::lock_guard<std::mutex> lock(startupLock);
+    if (startup.FirstWindow == Clock::duration::zero())
+        startup.FirstWindow = Clock::now() - startupBegin;
+}
+void RecordFirstEvent()
+{
+    std::lock_guard<std::mutex> lock(startupLock);
+    if (startup.FirstEvent == Clock::duration::zero())
+        startup.FirstEvent = Clock::now() - startupBegin;
+}
+static void NotifyMonitorsChanged()
+{
+    currentContext->monitorsChangedPending = false;
+
+    std::pmr::vector<Window*> wins(currentContext->frameResource);
+    wins.reserve(currentContext->windows.size());
+    for (auto&& it : currentContext->windows)
+        wins.push_back(it.first);
+
+    for (auto win : wins)
+    {
+        if (currentContext->windows.find(win) == currentContext->windows.end() || win->GetNativeWindow() == nullptr)
+            continue;
+
+        Event e;
+        e.type = EventType::MonitorsChanged;
+        DispatchEvent(win, &e);
+    }
+}
+// 由后端在收到显示器变化通知时调用；同一批通知可能发给每个顶层窗口，合并为一次事件
+void InvalidateMonitors()
+{
+    if (currentContext == nullptr)
+        return;
+
+    currentContext->monitorsValid = false;
+    if (currentContext->monitorsChangedPending)
+        return;
+
+    currentContext->monitorsChangedPending = true;
+    PostTask(NotifyMonitorsChanged);
+}
+// 只在当前线程的窗口中查找，同一时刻只有一个窗口拥有焦点
+Window* GetFocusedWindow()
+{
+    if (currentContext == nullptr)
+        return nullptr;
+
+    for (auto&& it : currentContext->windows)
+    {
+        if (it.first->GetNativeWindow() != nullptr && it.first->GetFocus())
+            return it.first;
+    }
+    return nullptr;
 }
 
 Application* Application::Current()
 {
-    return app;
+    return currentContext != nullptr ? currentContext->app : nullptr;
 }
 
 Application::Application()
 {
-    app = this;
-    AppInit();
+    bool first = applicationCount.fetch_add(1) == 0;
+    auto begin = Clock::now();
+    if (first)
+    {
+        std::lock_guard<std::mutex> lock(startupLock);
+        startupBegin = begin;
+        AppInit();
+    }
+
+    this->context = new LoopContext();
+    this->context->app = this;
+    this->context->thread = AppInitThread();
+    this->context->allocations = GetCountingResource().GetCount();
+    currentContext = this->context;
+
+    if (first)
+    {
+        std::lock_guard<std::mutex> lock(startupLock);
+        startup.Init = Clock::now() - begin;
+    }
 }
 
 Application::~Application()
 {
-    app = nullptr;
+    if (applicationCount.fetch_sub(1) == 1)
+        Gamepad::Stop();
+
+    StopWatchdog();
+
+    if (currentContext == this->context)
+    {
+        // 延迟渲染的剪贴板数据依赖本线程的 provider，在线程结束前交出
+        ClipboardBackendRelease();
+        currentContext = nullptr;
+    }
+
+    // 其他线程可能还持有这个 Application 并调用 InvokeAsync，由调用方保证在此之前停止投递
+    delete this->context;
+    this->context = nullptr;
+}
+
+void Application::InvokeAsync(const std::function<void()>& f)
+{
+    PostTask(context, f);
+}
+
+void Application::Invoke(const std::function<void()>& f)
+{
+    if (currentContext == this->context)
+    {
+        f();
+        return;
+    }
+
+    std::mutex lock;
+    std::condition_variable cond;
+    bool done = false;
+    PostTask(context, [&]()
+             {
+        f();
+        std::lock_guard<std::mutex> guard(lock);
+        done = true;
+        cond.notify_one(); });
+
+    std::unique_lock<std::mutex> locker(lock);
+    cond.wait(locker, [&]()
+              { return done; });
+}
+
+const std::vector<Monitor>& Application::GetMonitors()
+{
+    if (!context->monitorsValid)
+    {
+        context->monitors.clear();
+        AppQueryMonitors(context->monitors);
+        context->monitorsValid = true;
+    }
+    return context->monitors;
+}
+
+FrameStats Application::GetFrameStats() const
+{
+    return context->stats.Snapshot();
+}
+
+FrameStatsRecorder* GetLoopStats(LoopContext* context)
+{
+    return context != nullptr ? &context->stats : nullptr;
+}
+
+StartupTimings Application::GetStartupTimings()
+{
+    std::lock_guard<std::mutex> lock(startupLock);
+    return startup;
+}
+
+bool Application::StartWatchdog(std::chrono::steady_clock::duration threshold, const std::function<void(const StallReport&)>& callback)
+{
+    if (threshold <= Clock::duration::zero() || callback == nullptr)
+        return false;
+
+    StopWatchdog();
+
+    auto thread = WatchdogOpenThread();
+    if (thread == 0)
+        return false;
+
+    context->watchdog = std::make_unique<Watchdog>(context->activity, context->waiting, thread, threshold, callback);
+    watchdogActivity = &context->activity;
+    return true;
+}
+
+bool Application::StartWatchdog(std::chrono::steady_clock::duration threshold, const std::string& path)
+{
+    return StartWatchdog(threshold, [path](const StallReport& report)
+                         {
+        FILE* file = fopen(path.c_str(), "a");
+        if (file == nullptr)
+            return;
+
+        auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(report.Duration).count();
+        fprintf(file, "stall %lld ms, window %p, event %d\n", (long long)ms, (void*)report.ActiveWindow, (int)report.ActiveEvent);
+        for (auto&& frame : report.Stack)
+            fprintf(file, "    %s\n", frame.c_str());
+        fclose(file); });
+}
+
+void Application::StopWatchdog()
+{
+    if (currentContext == context)
+        watchdogActivity = nullptr;
+
+    context->watchdog = nullptr;
+}
+
+AllocationStats Application::GetAllocationStats()
+{
+    return {context->frameAllocations, GetCountingResource().GetCount()};
 }
 
 Window* Application::GetMainWindow()
 {
-    return mainWindow;
+    return context->mainWindow;
+}
+
+size_t Application::CreateWindows(std::span<Window* const> windows, bool show)
+{
+    std::vector<Window*> created;
+    created.reserve(windows.size());
+
+    bool creating = context->creatingWindows;
+    context->creatingWindows = true;
+    for (auto win : windows)
+    {
+        if (win != nullptr && win->Create())
+            created.push_back(win);
+    }
+    context->creatingWindows = creating;
+
+    if (show && !creating && !created.empty())
+        AppShowWindows(created);
+
+    return created.size();
+}
+
+WatchHandle Application::GetWaitHandle()
+{
+    if (!context->hasWaitHandle.load(std::memory_order_relaxed))
+    {
+        context->waitHandle = AppCreateWaitHandle();
+        context->hasWaitHandle.store(true, std::memory_order_release);
+
+        // 创建之前投递的任务没有触发句柄
+        AppSignalWaitHandle(context->waitHandle);
+    }
+    return context->waitHandle;
+}
+
+std::chrono::steady_clock::time_point Application::GetNextDeadline()
+{
+    {
+        std::lock_guard<std::mutex> lock(context->taskLock);
+        if (!context->tasks.empty())
+            return Clock::time_point::min();
+    }
+
+    if (context->commandsPending.load(std::memory_order_acquire))
+        return Clock::time_point::min();
+
+    return (std::min)(context->nextFrame, context->timers.NextDeadline());
+}
+
+bool Application::ProcessPending(std::chrono::steady_clock::duration budget)
+{
+    auto end = TimerWheel::AddSaturated(Clock::now(), budget);
+
+    // 先复位，处理期间到来的唤醒会保留到下一次
+    if (context->hasWaitHandle.load(std::memory_order_relaxed))
+        AppResetWaitHandle(context->waitHandle);
+
+    // 零超时的等待只分发已就绪的监视句柄
+    AppWait(Clock::duration::zero());
+
+    bool running;
+    context->loopDepth++;
+    do
+    {
+        running = RunOnce(this, nullptr);
+    } while (running && Clock::now() < end && GetNextDeadline() <= Clock::now());
+    context->loopDepth--;
+
+    // 宿主在两次调用之间的等待不算停顿
+    context->activity.heartbeat.store(context->iterations * 2 + 1, std::memory_order_relaxed);
+
+    return running;
 }
 
 int32_t Application::Run(Window* win)
 {
-    mainWindow = win;
+    context->mainWindow = win;
 
-    if (mainWindow != nullptr && !mainWindow->IsVisible())
-        mainWindow->Show();
+    if (win != nullptr && !win->IsVisible())
+        win->Show();
 
     RunLoop(this, nullptr);
     return 0;
+}
+
+uint32_t Application::SetTimeout(std::chrono::steady_clock::duration delay, const std::function<void()>& f)
+{
+    return context->timers.Add(TimerWheel::AddSaturated(Clock::now(), (std::max)(delay, Clock::duration::zero())), Clock::duration::zero(), f);
+}
+
+uint32_t Application::SetInterval(std::chrono::steady_clock::duration interval, const std::function<void()>& f)
+{
+    if (interval <= Clock::duration::zero())
+        interval = std::chrono::milliseconds(1);
+
+    return context->timers.Add(TimerWheel::AddSaturated(Clock::now(), interval), interval, f);
+}
+
+bool Application::CancelTimer(uint32_t id)
+{
+    return context->timers.Cancel(id);
 }
\ No newline at end of file
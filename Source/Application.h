@@ -1,20 +1,80 @@
 #pragma once
 #include <stdint.h>
+#include <chrono>
 #include <functional>
+#include <span>
+#include <string>
+#include <vector>
+#include "Clipboard.h"
+#include "FrameStats.h"
+#include "TaskPool.h"
+#include "Window.h"
 
 namespace tk
 {
-class Window;
+struct LoopContext;
 
+#ifdef _WIN32
+using WatchHandle = void*; // 可等待的 HANDLE，例如事件、进程或 WSAEventSelect 关联的事件
+#else
+using WatchHandle = int; // 文件描述符
+#endif
+
+constexpr uint32_t WATCH_READ = 1 << 0;
+constexpr uint32_t WATCH_WRITE = 1 << 1;
+
+// 库内部内存资源向系统堆申请内存的次数；投递的 std::function 等直接使用全局 operator new 的分配不在其中
+struct AllocationStats
+{
+    uint64_t LastFrame;
+    uint64_t Total;
+};
+
+// 坐标与 Window::GetRect 一致，以该显示器的 DpiScale 换算后的逻辑单位表示
+struct Monitor
+{
+    Rect<float> Bounds;
+    Rect<float> WorkArea;
+    float DpiScale;
+    float RefreshRate; // Hz，未知时为 0
+    bool Primary;
+};
+
+// 各阶段相对于 Application 构造的耗时，尚未发生的阶段为 0
+struct StartupTimings
+{
+    std::chrono::steady_clock::duration Init;        // AppInit，构造函数中同步完成的部分
+    std::chrono::steady_clock::duration Backend;     // 第一次创建窗口时延迟初始化的部分（不含窗口本身）
+    std::chrono::steady_clock::duration FirstWindow; // 第一个窗口创建完成
+    std::chrono::steady_clock::duration FirstEvent;  // 第一个窗口收到第一个系统事件
+};
+
+// Application::StartWatchdog 报告的一次停顿
+struct StallReport
+{
+    std::chrono::steady_clock::duration Duration; // 检测到时循环已经停顿的时间
+    Window* ActiveWindow;                          // 正在分发事件或执行 OnUpdate 的窗口，没有时为 nullptr；可能已被销毁，不能在回调中解引用
+    EventType ActiveEvent;                         // 正在分发的事件，在 OnUpdate 中或不在窗口回调中时为 None
+    std::vector<std::string> Stack;                // 被监视线程的调用栈，最内层在前；平台不支持时为空
+};
+
+// 每个线程可以拥有一个 Application，运行各自的消息循环；窗口属于创建它时所在线程的 Application
+// macOS 的事件循环只能运行在主线程，因此只支持主线程上的 Application
 class Application
 {
 public:
+    // 返回当前线程的 Application
     static Application* Current();
 
     Application();
 
+    Application(const Application&) = delete;
+    Application& operator=(const Application&) = delete;
+
     ~Application();
 
+    // 可以在任意线程调用，f 在该 Application 所在的线程执行
+
     void InvokeAsync(const std::function<void()>& f);
 
     void Invoke(const std::function<void()>& f);
@@ -34,10 +94,80 @@ public:
     //tk::StreamPtr LoadResource(const std::string& name);
     //#endif
 
+    // 定时器由 RunLoop 在主线程触发，只能在主线程调用
+    uint32_t SetTimeout(std::chrono::steady_clock::duration delay, const std::function<void()>& f);
+
+    uint32_t SetInterval(std::chrono::steady_clock::duration interval, const std::function<void()>& f);
+
+    bool CancelTimer(uint32_t id);
+
+    // 与窗口消息在同一个等待中复用，回调在主线程执行；只能在主线程调用
+    uint32_t AddWatch(WatchHandle handle, uint32_t events, const std::function<void(WatchHandle, uint32_t)>& callback);
+
+    bool RemoveWatch(uint32_t id);
+
+    // 结果会被缓存，只在显示器配置变化时重新查询，变化后向所有窗口发送 MonitorsChanged；只能在主线程调用
+    const std::vector<Monitor>& GetMonitors();
+
+    // 本线程消息循环的帧统计，可以在任意线程调用
+    FrameStats GetFrameStats() const;
+
+    StartupTimings GetStartupTimings();
+
+    // 在后台线程监视本线程的消息循环，一次循环超过 threshold 没有完成时采集本线程的调用栈并报告
+    // callback 在监视线程执行，同一次停顿只报告一次；等待消息和系统的模态循环（调整窗口大小、菜单）不算停顿
+    // 只能在本线程调用，再次调用会替换之前的设置
+    bool StartWatchdog(std::chrono::steady_clock::duration threshold, const std::function<void(const StallReport&)>& callback);
+
+    // 报告以文本追加到 path 指向的文件
+    bool StartWatchdog(std::chrono::steady_clock::duration threshold, const std::string& path);
+
+    void StopWatchdog();
+
+    AllocationStats GetAllocationStats();
+
     Window* GetMainWindow();
 
+    // 设置剪贴板，只登记格式，数据在被请求时才由 provider 生成；只能在本线程调用，provider 也在本线程执行
+    bool SetClipboard(const std::vector<ClipboardItem>& items);
+    bool SetClipboardText(const std::string& text);
+
+    std::vector<std::string> GetClipboardFormats();
+
+    // 在后台线程读取，reader 在本线程的后续循环中逐块调用；Application 必须存在到最后一块交付
+    void GetClipboardAsync(const std::string& format, const ClipboardReader& reader, size_t chunkSize = 64 * 1024);
+
+    // task 在 TaskPool::Default() 中执行，用返回值的 Then 把结果交回本线程；只能在本线程调用，Application 必须存在到结果交付
+    // 指定 window 时，窗口关闭或销毁后任务不再开始、结果不再交付，Then 的回调中可以直接使用该窗口
+    template <typename F>
+    BackgroundTask<std::invoke_result_t<std::decay_t<F>&>> RunInBackground(F&& task, Window* window = nullptr)
+    {
+        using T = std::invoke_result_t<std::decay_t<F>&>;
+        auto state = std::make_shared<BackgroundTaskState<T>>(this, window);
+        TaskPool::Default().Post([state, task = std::forward<F>(task)]() mutable
+                                 { state->Run(task); });
+        return BackgroundTask<T>(state);
+    }
+
+    // 依次调用每个窗口的 Create()，期间推迟窗口的显示和绘制，全部创建完成后一起显示，返回创建成功的窗口数
+    // 窗口在这之后的第一次循环中一起收到 OnUpdate；只能在本线程调用
+    size_t CreateWindows(std::span<Window* const> windows, bool show = true);
+
     bool Update();
 
+    // 嵌入外部事件循环（asio、libuv 等）时代替 Run：在 GetWaitHandle 就绪或到达 GetNextDeadline 时调用 ProcessPending
+    // 句柄在有任务投递、其他线程提交窗口命令时就绪，可以直接交给外部循环等待；
+    // 窗口消息不经过句柄：Windows 上需要同时以 QS_ALLINPUT 等待本线程的消息队列，macOS 上由主线程的 RunLoop 接收
+    // 以上都只能在本线程调用
+    WatchHandle GetWaitHandle();
+
+    // 最早需要处理的时间：有待执行的任务时为 time_point::min()，没有定时器和窗口更新时为 time_point::max()
+    std::chrono::steady_clock::time_point GetNextDeadline();
+
+    // 处理窗口消息、任务、定时器和到期的 OnUpdate 后立即返回，不等待；至少处理一轮，在 budget 内继续处理仍然到期的工作
+    // 返回 false 表示应当结束，条件与 Run 返回相同
+    bool ProcessPending(std::chrono::steady_clock::duration budget);
+
     int32_t Run(Window* win);
 
     template <typename WINDOW>
@@ -49,5 +179,8 @@ public:
     }
 
     void Exit();
+
+private:
+    LoopContext* context = nullptr;
 };
 } // namespace tk
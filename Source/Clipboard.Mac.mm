@@ -0,0 +1,124 @@
+#if defined(__APPLE__)
+#include "TargetConditionals.h"
+#if defined(TARGET_OS_MAC)
+
+#import <Cocoa/Cocoa.h>
+#include <map>
+#include "Clipboard.h"
+
+using namespace tk;
+
+static NSPasteboardType ToPasteboardType(const std::string& format)
+{
+    if (format == CLIPBOARD_TEXT)
+        return NSPasteboardTypeString;
+    if (format == CLIPBOARD_PNG)
+        return NSPasteboardTypePNG;
+
+    return [NSString stringWithUTF8String:format.c_str()];
+}
+
+static std::string FromPasteboardType(NSPasteboardType type)
+{
+    if ([type isEqualToString:NSPasteboardTypeString])
+        return CLIPBOARD_TEXT;
+    if ([type isEqualToString:NSPasteboardTypePNG])
+        return CLIPBOARD_PNG;
+
+    return [type UTF8String];
+}
+
+@interface ClipboardDataProvider : NSObject <NSPasteboardItemDataProvider>
+{
+  @public
+    std::map<std::string, ClipboardProvider> providers;
+}
+@end
+
+// 当前剪贴板的数据来源，由剪贴板被其他内容替换时释放
+static ClipboardDataProvider* clipboardProvider = nil;
+
+@implementation ClipboardDataProvider
+
+- (void)pasteboard:(NSPasteboard*)pasteboard item:(NSPasteboardItem*)item provideDataForType:(NSPasteboardType)type
+{
+    auto it = providers.find([type UTF8String]);
+    if (it == providers.end() || !it->second)
+        return;
+
+    // 本程序在后台线程读取时也会在那个线程请求数据，provider 总是在主线程调用
+    __block std::vector<uint8_t> data;
+    auto& provider = it->second;
+    if ([NSThread isMainThread])
+        data = provider();
+    else
+        dispatch_sync(dispatch_get_main_queue(), ^{
+          data = provider();
+        });
+
+    [item setData:[NSData dataWithBytes:data.data() length:data.size()] forType:type];
+}
+
+- (void)pasteboardFinishedWithDataProvider:(NSPasteboard*)pasteboard
+{
+    if (clipboardProvider == self)
+        clipboardProvider = nil;
+}
+@end
+
+bool ClipboardBackendSet(const std::vector<ClipboardItem>& items)
+{
+    @autoreleasepool
+    {
+        ClipboardDataProvider* provider = [[ClipboardDataProvider alloc] init];
+        NSMutableArray<NSPasteboardType>* types = [NSMutableArray array];
+        for (auto&& item : items)
+        {
+            NSPasteboardType type = ToPasteboardType(item.Format);
+            provider->providers[[type UTF8String]] = item.Provider;
+            [types addObject:type];
+        }
+
+        NSPasteboardItem* item = [[NSPasteboardItem alloc] init];
+        if (![item setDataProvider:provider forTypes:types])
+            return false;
+
+        NSPasteboard* pasteboard = [NSPasteboard generalPasteboard];
+        [pasteboard clearContents];
+        clipboardProvider = provider;
+        return [pasteboard writeObjects:@[ item ]];
+    }
+}
+
+// 在后台线程调用
+bool ClipboardBackendRead(const std::string& format, std::vector<uint8_t>& data)
+{
+    @autoreleasepool
+    {
+        NSData* value = [[NSPasteboard generalPasteboard] dataForType:ToPasteboardType(format)];
+        if (value == nil)
+            return false;
+
+        auto bytes = (const uint8_t*)[value bytes];
+        data.assign(bytes, bytes + [value length]);
+        return true;
+    }
+}
+
+// 数据来源由粘贴板在内容被替换时释放，没有属于线程的资源
+void ClipboardBackendRelease()
+{
+}
+
+std::vector<std::string> ClipboardBackendFormats()
+{
+    std::vector<std::string> formats;
+    @autoreleasepool
+    {
+        for (NSPasteboardType type in [[NSPasteboard generalPasteboard] types])
+            formats.push_back(FromPasteboardType(type));
+    }
+    return formats;
+}
+#endif
+#endif
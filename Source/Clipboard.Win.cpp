@@ -0,0 +1,243 @@
+#ifdef _WIN32
+#include <Windows.h>
+#include <algorithm>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include "Clipboard.h"
+
+using namespace tk;
+
+// 延迟渲染需要一个拥有剪贴板的窗口，每个设置过剪贴板的线程一个仅消息窗口
+static thread_local HWND clipboardWindow = NULL;
+static thread_local std::map<UINT, ClipboardProvider> clipboardProviders;
+
+// GlobalSize 可能向上取整，空数据也占 1 字节；记录自己渲染的数据的实际长度，读取时按它截断
+static std::mutex renderedLock;
+static std::map<HGLOBAL, size_t> renderedLengths;
+
+static void ForgetRenderedLengths()
+{
+    std::lock_guard<std::mutex> lock(renderedLock);
+    renderedLengths.clear();
+}
+
+static UINT ToClipboardFormat(const std::string& format)
+{
+    if (format == CLIPBOARD_TEXT)
+        return CF_UNICODETEXT;
+    if (format == CLIPBOARD_PNG)
+        return RegisterClipboardFormatW(L"PNG");
+
+    return RegisterClipboardFormatA(format.c_str());
+}
+
+static std::string FromClipboardFormat(UINT format)
+{
+    if (format == CF_UNICODETEXT)
+        return CLIPBOARD_TEXT;
+
+    char name[256];
+    int length = GetClipboardFormatNameA(format, name, sizeof(name));
+    if (length <= 0)
+        return {};
+    if (strcmp(name, "PNG") == 0)
+        return CLIPBOARD_PNG;
+
+    return std::string(name, length);
+}
+
+static HGLOBAL RenderClipboardFormat(UINT format, const ClipboardProvider& provider)
+{
+    auto data = provider();
+
+    HGLOBAL memory = NULL;
+    if (format == CF_UNICODETEXT)
+    {
+        int length = MultiByteToWideChar(CP_UTF8, 0, (const char*)data.data(), (int)data.size(), NULL, 0);
+        memory = GlobalAlloc(GMEM_MOVEABLE, (length + 1) * sizeof(WCHAR));
+        if (memory == NULL)
+            return NULL;
+
+        auto text = (WCHAR*)GlobalLock(memory);
+        MultiByteToWideChar(CP_UTF8, 0, (const char*)data.data(), (int)data.size(), text, length);
+        text[length] = 0;
+    }
+    else
+    {
+        memory = GlobalAlloc(GMEM_MOVEABLE, (std::max)(data.size(), (size_t)1));
+        if (memory == NULL)
+            return NULL;
+
+        memcpy(GlobalLock(memory), data.data(), data.size());
+
+        std::lock_guard<std::mutex> lock(renderedLock);
+        renderedLengths[memory] = data.size();
+    }
+    GlobalUnlock(memory);
+    return memory;
+}
+
+static void RenderClipboardFormat(UINT format)
+{
+    auto it = clipboardProviders.find(format);
+    if (it == clipboardProviders.end() || !it->second)
+        return;
+
+    HGLOBAL memory = RenderClipboardFormat(format, it->second);
+    if (memory != NULL && SetClipboardData(format, memory) == NULL)
+    {
+        {
+            std::lock_guard<std::mutex> lock(renderedLock);
+            renderedLengths.erase(memory);
+        }
+        GlobalFree(memory);
+    }
+}
+
+static LRESULT WINAPI ClipboardWndProc(HWND hWnd, UINT msg, WPARAM wParam, LPARAM lParam)
+{
+    switch (msg)
+    {
+        case WM_RENDERFORMAT:
+            // 剪贴板已经由请求方打开
+            RenderClipboardFormat((UINT)wParam);
+            return 0;
+        case WM_RENDERALLFORMATS:
+            // 窗口销毁前必须交出所有数据，否则其他程序无法再读取
+            if (OpenClipboard(hWnd))
+            {
+                if (GetClipboardOwner() == hWnd)
+                {
+                    for (auto&& it : clipboardProviders)
+                        RenderClipboardFormat(it.first);
+                }
+                CloseClipboard();
+            }
+            return 0;
+        case WM_DESTROYCLIPBOARD:
+            clipboardProviders.clear();
+            ForgetRenderedLengths();
+            return 0;
+    }
+
+    return DefWindowProcW(hWnd, msg, wParam, lParam);
+}
+
+bool ClipboardBackendSet(const std::vector<ClipboardItem>& items)
+{
+    if (clipboardWindow == NULL)
+    {
+        static ATOM windowClass = 0;
+        if (windowClass == 0)
+        {
+            WNDCLASSEXW wc = {sizeof(WNDCLASSEXW), 0, ClipboardWndProc, 0L, 0L, GetModuleHandle(NULL), NULL, NULL, NULL, NULL, L"ClipboardOwner", NULL};
+            windowClass = RegisterClassExW(&wc);
+        }
+
+        clipboardWindow = CreateWindowExW(0, L"ClipboardOwner", L"", 0, 0, 0, 0, 0, HWND_MESSAGE, NULL, GetModuleHandle(NULL), NULL);
+        if (clipboardWindow == NULL)
+            return false;
+    }
+
+    if (!OpenClipboard(clipboardWindow))
+        return false;
+
+    // EmptyClipboard 会向之前的所有者（可能是自己）发送 WM_DESTROYCLIPBOARD，之后再登记新的 provider
+    EmptyClipboard();
+    ForgetRenderedLengths();
+    for (auto&& item : items)
+    {
+        UINT format = ToClipboardFormat(item.Format);
+        if (format == 0)
+            continue;
+
+        clipboardProviders[format] = item.Provider;
+        SetClipboardData(format, NULL);
+    }
+    CloseClipboard();
+    return true;
+}
+
+// 在后台线程调用；来源使用延迟渲染时 GetClipboardData 会等待所有者处理 WM_RENDERFORMAT
+bool ClipboardBackendRead(const std::string& format, std::vector<uint8_t>& data)
+{
+    UINT cf = ToClipboardFormat(format);
+    if (cf == 0 || !IsClipboardFormatAvailable(cf))
+        return false;
+
+    // 其他程序可能短暂占用剪贴板
+    bool opened = false;
+    for (int32_t i = 0; i < 10 && !(opened = OpenClipboard(NULL)); i++)
+        Sleep(10);
+    if (!opened)
+        return false;
+
+    bool ok = false;
+    HANDLE memory = GetClipboardData(cf);
+    if (memory != NULL)
+    {
+        auto bytes = (const uint8_t*)GlobalLock(memory);
+        size_t size = GlobalSize(memory);
+
+        // 所有者是本进程的窗口时，记录的句柄都属于当前内容
+        DWORD process = 0;
+        GetWindowThreadProcessId(GetClipboardOwner(), &process);
+        if (process == GetCurrentProcessId())
+        {
+            std::lock_guard<std::mutex> lock(renderedLock);
+            auto it = renderedLengths.find((HGLOBAL)memory);
+            if (it != renderedLengths.end())
+                size = (std::min)(size, it->second);
+        }
+        if (bytes != nullptr)
+        {
+            if (cf == CF_UNICODETEXT)
+            {
+                auto text = (const WCHAR*)bytes;
+                int length = (int)wcsnlen(text, size / sizeof(WCHAR));
+                int count = WideCharToMultiByte(CP_UTF8, 0, text, length, NULL, 0, NULL, NULL);
+                data.resize(count);
+                WideCharToMultiByte(CP_UTF8, 0, text, length, (char*)data.data(), count, NULL, NULL);
+            }
+            else
+            {
+                data.assign(bytes, bytes + size);
+            }
+            GlobalUnlock(memory);
+            ok = true;
+        }
+    }
+
+    CloseClipboard();
+    return ok;
+}
+
+// 由 ~Application 在所属线程调用；销毁窗口时系统发送 WM_RENDERALLFORMATS，此时 provider 仍然有效
+void ClipboardBackendRelease()
+{
+    if (clipboardWindow == NULL)
+        return;
+
+    DestroyWindow(clipboardWindow);
+    clipboardWindow = NULL;
+    clipboardProviders.clear();
+}
+
+std::vector<std::string> ClipboardBackendFormats()
+{
+    std::vector<std::string> formats;
+    if (!OpenClipboard(NULL))
+        return formats;
+
+    for (UINT format = EnumClipboardFormats(0); format != 0; format = EnumClipboardFormats(format))
+    {
+        auto name = FromClipboardFormat(format);
+        if (!name.empty())
+            formats.push_back(std::move(name));
+    }
+
+    CloseClipboard();
+    return formats;
+}
+#endif
@@ -0,0 +1,67 @@
+#include <algorithm>
+#include <memory>
+#include <thread>
+#include "Application.h"
+#include "Clipboard.h"
+
+using namespace tk;
+
+extern bool ClipboardBackendSet(const std::vector<ClipboardItem>& items);
+extern bool ClipboardBackendRead(const std::string& format, std::vector<uint8_t>& data);
+extern std::vector<std::string> ClipboardBackendFormats();
+
+struct ClipboardRead
+{
+    std::vector<uint8_t> data;
+    size_t offset = 0;
+    size_t chunkSize;
+    ClipboardReader reader;
+};
+
+// 每次循环只交付一块，大数据不会让一次循环停顿太久
+static void DeliverClipboardChunk(Application* app, const std::shared_ptr<ClipboardRead>& read)
+{
+    size_t size = (std::min)(read->chunkSize, read->data.size() - read->offset);
+    bool last = read->offset + size >= read->data.size();
+    read->reader({read->data.data() + read->offset, size}, last);
+    read->offset += size;
+
+    if (!last)
+    {
+        app->InvokeAsync([app, read]()
+                         { DeliverClipboardChunk(app, read); });
+    }
+}
+
+bool Application::SetClipboard(const std::vector<ClipboardItem>& items)
+{
+    return ClipboardBackendSet(items);
+}
+
+bool Application::SetClipboardText(const std::string& text)
+{
+    return SetClipboard({{CLIPBOARD_TEXT, [text]()
+                          { return std::vector<uint8_t>(text.begin(), text.end()); }}});
+}
+
+std::vector<std::string> Application::GetClipboardFormats()
+{
+    return ClipboardBackendFormats();
+}
+
+void Application::GetClipboardAsync(const std::string& format, const ClipboardReader& reader, size_t chunkSize)
+{
+    auto read = std::make_shared<ClipboardRead>();
+    read->chunkSize = (std::max)(chunkSize, (size_t)1);
+    read->reader = reader;
+
+    // 数据来源可能是延迟渲染的其他程序，读取在后台线程进行，UI 线程只接收结果
+    std::thread([this, format, read]()
+                {
+        if (!ClipboardBackendRead(format, read->data))
+            read->data.clear();
+
+        InvokeAsync([this, read]()
+                    { DeliverClipboardChunk(this, read); }); })
+        .detach();
+}
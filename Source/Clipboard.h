@@ -0,0 +1,25 @@
+#pragma once
+#include <functional>
+#include <span>
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+namespace tk
+{
+// 剪贴板格式使用 MIME 名称；其他名称在 Windows 上作为注册的格式名，在 macOS 上作为 UTI
+constexpr const char* CLIPBOARD_TEXT = "text/plain"; // UTF-8 文本，不含结尾的 0
+constexpr const char* CLIPBOARD_PNG = "image/png";
+
+// 只在其他程序（或本程序）请求该格式时才调用，在设置剪贴板的线程上执行
+using ClipboardProvider = std::function<std::vector<uint8_t>()>;
+
+struct ClipboardItem
+{
+    std::string Format;
+    ClipboardProvider Provider;
+};
+
+// 按块接收剪贴板数据，最后一块的 last 为 true；格式不存在时只调用一次，chunk 为空
+using ClipboardReader = std::function<void(std::span<const uint8_t> chunk, bool last)>;
+} // namespace tk
@@ -0,0 +1,307 @@
+#include <cstring>
+#include "EventQueue.h"
+
+extern void DrainTasks();
+
+using namespace tk;
+
+// 等待分发权时执行本线程任务的间隔
+constexpr auto DISPATCH_POLL_INTERVAL = std::chrono::milliseconds(1);
+
+static size_t PayloadSize(EventType type)
+{
+    switch (type)
+    {
+        case EventType::TextInput:
+            return sizeof(TextInputEvent);
+        case EventType::TextComposition:
+            return sizeof(TextCompositionEvent);
+        case EventType::KeyDown:
+        case EventType::KeyUp:
+        case EventType::KeyPress:
+            return sizeof(KeyEvent);
+        case EventType::MouseDown:
+        case EventType::MouseUp:
+        case EventType::MouseClick:
+        case EventType::MouseDoubleClick:
+            return sizeof(MouseButtonEvent);
+        case EventType::MouseWheel:
+            return sizeof(MouseWheelEvent);
+        default:
+            return sizeof(Event);
+    }
+}
+
+static bool IsSynchronous(EventType type)
+{
+    switch (type)
+    {
+        case EventType::Create:
+        case EventType::Closing:
+        case EventType::Closed:
+            return true;
+        default:
+            return false;
+    }
+}
+
+// 截断到不超过 length 的 UTF-8 字符边界
+static size_t Utf8Boundary(const char* text, size_t length)
+{
+    while (length > 0 && ((unsigned char)text[length] & 0xC0) == 0x80)
+        length--;
+    return length;
+}
+
+EventQueue::EventQueue(size_t capacity)
+{
+    size_t size = 2;
+    while (size < capacity)
+        size <<= 1;
+
+    records.resize(size);
+    mask = size - 1;
+    overflow.reserve(size);
+    overflowDrain.reserve(size);
+}
+
+EventQueue::~EventQueue()
+{
+    Stop();
+
+    DispatchScope scope(this);
+    for (auto win : windows)
+        win->eventQueue = nullptr;
+}
+
+EventQueue::DispatchScope::DispatchScope(EventQueue* queue) : queue(queue)
+{
+    if (queue != nullptr)
+        queue->Acquire();
+}
+
+EventQueue::DispatchScope::~DispatchScope()
+{
+    if (queue != nullptr)
+        queue->Release();
+}
+
+void EventQueue::Acquire()
+{
+    auto self = std::this_thread::get_id();
+    std::unique_lock<std::mutex> lock(dispatchLock);
+    while (dispatchDepth > 0 && dispatchOwner != self)
+    {
+        // 持有者的回调可能正在用 Application::Invoke 等待本线程，等待期间继续执行本线程的任务
+        lock.unlock();
+        DrainTasks();
+        lock.lock();
+        if (dispatchDepth > 0 && dispatchOwner != self)
+            dispatchCond.wait_for(lock, DISPATCH_POLL_INTERVAL);
+    }
+    dispatchOwner = self;
+    dispatchDepth++;
+}
+
+void EventQueue::Release()
+{
+    std::lock_guard<std::mutex> lock(dispatchLock);
+    if (--dispatchDepth == 0)
+    {
+        dispatchOwner = std::thread::id();
+        dispatchCond.notify_all();
+    }
+}
+
+void EventQueue::FillRecord(Record& record, Window* win, Event* e, const char* text, size_t length)
+{
+    record.window = win;
+    record.type = e->type;
+    record.textLength = (uint32_t)length;
+    memcpy(record.payload, e, PayloadSize(e->type));
+    if (length > 0)
+        memcpy(record.text, text, length);
+}
+
+void EventQueue::Notify()
+{
+    // 与 Wait 中的屏障配对，避免消费者在检查后才睡眠而错过通知
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (sleeping.load(std::memory_order_relaxed))
+    {
+        std::lock_guard<std::mutex> lock(waitLock);
+        waitCond.notify_one();
+    }
+}
+
+bool EventQueue::TryPush(Window* win, Event* e, const char* text, size_t length)
+{
+    auto t = tail.load(std::memory_order_relaxed);
+    if (t - head.load(std::memory_order_acquire) > mask)
+        return false;
+
+    FillRecord(records[t & mask], win, e, text, length);
+    tail.store(t + 1, std::memory_order_release);
+    Notify();
+    return true;
+}
+
+// 不等待消费者：缓冲区满时追加到溢出列表，列表也满时返回 false
+bool EventQueue::PushOverflow(Window* win, Event* e, const char* text, size_t length)
+{
+    {
+        std::lock_guard<std::mutex> lock(overflowLock);
+
+        // 消费者可能刚取走列表，缓冲区又可以使用
+        if (!overflowing.load(std::memory_order_relaxed) && TryPush(win, e, text, length))
+            return true;
+
+        if (e->type == EventType::MouseMove || overflow.size() >= records.size())
+            return false;
+
+        FillRecord(overflow.emplace_back(), win, e, text, length);
+        overflowing.store(true, std::memory_order_release);
+    }
+    Notify();
+    return true;
+}
+
+void EventQueue::Push(Window* win, Event* e)
+{
+    if (IsSynchronous(e->type))
+        return DispatchSync(win, e);
+
+    std::string_view text;
+    if (e->type == EventType::TextInput)
+        text = static_cast<TextInputEvent*>(e)->Text;
+    else if (e->type == EventType::TextComposition)
+        text = static_cast<TextCompositionEvent*>(e)->Text;
+
+    // 组合文本必须完整送达，过长时退回同步分发；输入的文本按字符边界拆成多个事件
+    if (text.size() > TEXT_CAPACITY && e->type == EventType::TextComposition)
+        return DispatchSync(win, e);
+
+    do
+    {
+        size_t length = text.size() > TEXT_CAPACITY ? Utf8Boundary(text.data(), TEXT_CAPACITY) : text.size();
+        bool pushed = !overflowing.load(std::memory_order_acquire) && TryPush(win, e, text.data(), length);
+        if (!pushed && !PushOverflow(win, e, text.data(), length))
+        {
+            dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        text.remove_prefix(length);
+    } while (!text.empty());
+}
+
+void EventQueue::DispatchSync(Window* win, Event* e)
+{
+    DispatchScope scope(this);
+
+    // 等待分发权期间执行的任务可能已经销毁窗口
+    if (windows.count(win) != 0)
+        win->OnEvent(e);
+}
+
+void EventQueue::Attach(Window* win)
+{
+    DispatchScope scope(this);
+    windows.insert(win);
+    win->eventQueue = this;
+}
+
+void EventQueue::Detach(Window* win)
+{
+    // 取得分发权后消费者不会再分发给这个窗口，残留的事件会被丢弃
+    DispatchScope scope(this);
+    windows.erase(win);
+    win->eventQueue = nullptr;
+}
+
+size_t EventQueue::Dispatch(const Record& record)
+{
+    alignas(std::max_align_t) unsigned char payload[sizeof(record.payload)];
+    memcpy(payload, record.payload, sizeof(payload));
+    auto e = reinterpret_cast<Event*>(payload);
+    if (record.type == EventType::TextInput)
+        reinterpret_cast<TextInputEvent*>(payload)->Text = std::string_view(record.text, record.textLength);
+    else if (record.type == EventType::TextComposition)
+        reinterpret_cast<TextCompositionEvent*>(payload)->Text = std::string_view(record.text, record.textLength);
+
+    DispatchScope scope(this);
+    if (windows.count(record.window) == 0)
+        return 0;
+
+    record.window->OnEvent(e);
+    return 1;
+}
+
+size_t EventQueue::Drain()
+{
+    size_t count = 0;
+    auto h = head.load(std::memory_order_relaxed);
+    auto t = tail.load(std::memory_order_acquire);
+    for (; h != t; h++)
+    {
+        count += Dispatch(records[h & mask]);
+        head.store(h + 1, std::memory_order_release);
+    }
+
+    // 溢出期间生产者不再写缓冲区，缓冲区取空后列表中的事件都在已分发的事件之后
+    if (overflowing.load(std::memory_order_acquire) && tail.load(std::memory_order_acquire) == h)
+    {
+        {
+            std::lock_guard<std::mutex> lock(overflowLock);
+            overflow.swap(overflowDrain);
+            overflowing.store(false, std::memory_order_relaxed);
+        }
+        for (auto&& record : overflowDrain)
+            count += Dispatch(record);
+        overflowDrain.clear();
+    }
+    return count;
+}
+
+bool EventQueue::Wait(std::chrono::steady_clock::duration timeout)
+{
+    auto ready = [this]()
+    {
+        return head.load(std::memory_order_relaxed) != tail.load(std::memory_order_acquire) || overflowing.load(std::memory_order_acquire) || stopping.load(std::memory_order_relaxed);
+    };
+
+    sleeping.store(true, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    std::unique_lock<std::mutex> lock(waitLock);
+    bool result = waitCond.wait_for(lock, timeout, ready);
+    sleeping.store(false, std::memory_order_relaxed);
+    return result;
+}
+
+void EventQueue::Start()
+{
+    if (running.exchange(true))
+        return;
+
+    stopping = false;
+    consumer = std::thread([this]()
+                           {
+        while (!stopping.load(std::memory_order_relaxed))
+        {
+            if (Drain() == 0)
+                Wait(std::chrono::milliseconds(100));
+        } });
+}
+
+void EventQueue::Stop()
+{
+    if (!running.exchange(false))
+        return;
+
+    stopping = true;
+    {
+        std::lock_guard<std::mutex> lock(waitLock);
+        waitCond.notify_one();
+    }
+    if (consumer.joinable())
+        consumer.join();
+}
@@ -0,0 +1,110 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+#include "Window.h"
+
+namespace tk
+{
+// 单生产者单消费者的事件环形缓冲区
+// 窗口通过 Window::SetEventQueue 关联后，消息循环只把事件复制进缓冲区，由消费线程调用 OnEvent
+// Create、Closing、Closed 等需要立即得到结果的事件仍然同步分发，与消费线程轮流取得分发权
+class EventQueue
+{
+public:
+    static constexpr size_t TEXT_CAPACITY = 64;
+
+    // capacity 会向上取整为 2 的幂，缓冲区满时另有同样大小的溢出列表
+    explicit EventQueue(size_t capacity = 1024);
+
+    ~EventQueue();
+
+    EventQueue(const EventQueue&) = delete;
+    EventQueue& operator=(const EventQueue&) = delete;
+
+    // 在消费线程调用，分发当前所有事件，返回分发的数量
+    size_t Drain();
+
+    // 在消费线程调用，等待直到有事件、超时或 Stop
+    bool Wait(std::chrono::steady_clock::duration timeout);
+
+    // 启动内部消费线程；也可以不调用，由使用者的线程循环调用 Wait 和 Drain
+    void Start();
+
+    void Stop();
+
+    // 丢弃的事件数：鼠标移动在缓冲区满时丢弃，其他事件在溢出列表也满时丢弃
+    uint64_t GetDroppedCount() const { return dropped.load(std::memory_order_relaxed); }
+
+private:
+    friend class Window;
+    friend void DispatchEvent(Window* win, Event* e);
+
+    struct Record
+    {
+        Window* window;
+        EventType type;
+        uint32_t textLength;
+        alignas(std::max_align_t) unsigned char payload[sizeof(TextCompositionEvent) > sizeof(KeyEvent) ? sizeof(TextCompositionEvent) : sizeof(KeyEvent)];
+        char text[TEXT_CAPACITY];
+    };
+
+    // 分发权：同一时刻只有一个线程调用关联窗口的 OnEvent 或修改它们的监听器，同一线程可以重入
+    // 回调期间不持有任何锁；queue 为 nullptr 时什么也不做
+    class DispatchScope
+    {
+    public:
+        explicit DispatchScope(EventQueue* queue);
+        ~DispatchScope();
+
+        DispatchScope(const DispatchScope&) = delete;
+        DispatchScope& operator=(const DispatchScope&) = delete;
+
+    private:
+        EventQueue* queue;
+    };
+
+    // 由窗口所属的线程调用
+    void Push(Window* win, Event* e);
+    bool TryPush(Window* win, Event* e, const char* text, size_t length);
+    bool PushOverflow(Window* win, Event* e, const char* text, size_t length);
+    void DispatchSync(Window* win, Event* e);
+    void Attach(Window* win);
+    void Detach(Window* win);
+
+    static void FillRecord(Record& record, Window* win, Event* e, const char* text, size_t length);
+    void Notify();
+    size_t Dispatch(const Record& record);
+    void Acquire();
+    void Release();
+
+    std::vector<Record> records;
+    size_t mask;
+    alignas(64) std::atomic<size_t> head = 0; // 消费者位置
+    alignas(64) std::atomic<size_t> tail = 0; // 生产者位置
+    alignas(64) std::atomic<bool> sleeping = false;
+    std::atomic<uint64_t> dropped = 0;
+
+    std::mutex waitLock;
+    std::condition_variable waitCond;
+
+    // 溢出期间的事件都进入列表以保持顺序，消费者取空缓冲区后整体交换出来处理
+    std::mutex overflowLock;
+    std::vector<Record> overflow;
+    std::vector<Record> overflowDrain;
+    std::atomic<bool> overflowing = false;
+
+    std::mutex dispatchLock;
+    std::condition_variable dispatchCond;
+    std::thread::id dispatchOwner;
+    uint32_t dispatchDepth = 0;
+    std::unordered_set<Window*> windows; // 由分发权保护
+
+    std::thread consumer;
+    std::atomic<bool> running = false;
+    std::atomic<bool> stopping = false;
+};
+} // namespace tk
@@ -0,0 +1,85 @@
+#include <algorithm>
+#include <bit>
+#include "FrameStats.h"
+
+using namespace tk;
+
+size_t FrameStats::BucketIndex(uint64_t us)
+{
+    constexpr uint64_t LINEAR = 2ull << SUB_BUCKET_BITS;
+    if (us < LINEAR)
+        return (size_t)us;
+
+    size_t shift = (size_t)std::bit_width(us) - 1 - SUB_BUCKET_BITS;
+    size_t index = (shift << SUB_BUCKET_BITS) + (size_t)(us >> shift);
+    return (std::min)(index, BUCKETS - 1);
+}
+
+std::chrono::microseconds FrameStats::BucketLowerBound(size_t index)
+{
+    constexpr size_t LINEAR = 2ull << SUB_BUCKET_BITS;
+    if (index < LINEAR)
+        return std::chrono::microseconds(index);
+
+    size_t shift = (index >> SUB_BUCKET_BITS) - 1;
+    uint64_t mantissa = (index & ((1ull << SUB_BUCKET_BITS) - 1)) | (1ull << SUB_BUCKET_BITS);
+    return std::chrono::microseconds(mantissa << shift);
+}
+
+std::chrono::microseconds FrameStats::Percentile(double p) const
+{
+    uint64_t total = 0;
+    for (auto count : Histogram)
+        total += count;
+
+    if (total == 0)
+        return std::chrono::microseconds::zero();
+
+    uint64_t target = (uint64_t)(std::clamp(p, 0.0, 1.0) * (double)(total - 1));
+    uint64_t seen = 0;
+    for (size_t i = 0; i < BUCKETS; i++)
+    {
+        seen += Histogram[i];
+        if (seen > target)
+            return BucketLowerBound(i);
+    }
+    return BucketLowerBound(BUCKETS - 1);
+}
+
+void FrameStatsRecorder::RecordFrame(std::chrono::nanoseconds frameTime)
+{
+    Increase(frames);
+
+    auto us = std::chrono::duration_cast<std::chrono::microseconds>(frameTime).count();
+    Increase(histogram[FrameStats::BucketIndex((uint64_t)(std::max)(us, (int64_t)0))]);
+
+    if (frameTime.count() > maxFrameTime.load(std::memory_order_relaxed))
+        maxFrameTime.store(frameTime.count(), std::memory_order_relaxed);
+
+    auto e = events.load(std::memory_order_relaxed);
+    lastFrameEvents.store(e - frameEventsStart, std::memory_order_relaxed);
+    frameEventsStart = e;
+
+    auto t = tasks.load(std::memory_order_relaxed);
+    lastFrameTasks.store(t - frameTasksStart, std::memory_order_relaxed);
+    frameTasksStart = t;
+}
+
+FrameStats FrameStatsRecorder::Snapshot() const
+{
+    FrameStats stats;
+    stats.Frames = frames.load(std::memory_order_relaxed);
+    stats.MissedFrames = missedFrames.load(std::memory_order_relaxed);
+    stats.Events = events.load(std::memory_order_relaxed);
+    stats.Tasks = tasks.load(std::memory_order_relaxed);
+    stats.LastFrameEvents = lastFrameEvents.load(std::memory_order_relaxed);
+    stats.LastFrameTasks = lastFrameTasks.load(std::memory_order_relaxed);
+    stats.WakeUps = wakeUps.load(std::memory_order_relaxed);
+    stats.UpdateTime = std::chrono::nanoseconds(updateTime.load(std::memory_order_relaxed));
+    stats.OnUpdateTime = std::chrono::nanoseconds(onUpdateTime.load(std::memory_order_relaxed));
+    stats.SleepTime = std::chrono::nanoseconds(sleepTime.load(std::memory_order_relaxed));
+    stats.MaxFrameTime = std::chrono::nanoseconds(maxFrameTime.load(std::memory_order_relaxed));
+    for (size_t i = 0; i < FrameStats::BUCKETS; i++)
+        stats.Histogram[i] = histogram[i].load(std::memory_order_relaxed);
+    return stats;
+}
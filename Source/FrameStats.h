@@ -0,0 +1,83 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <stdint.h>
+
+namespace tk
+{
+// 帧统计的快照
+// 帧耗时直方图按微秒分桶：小于 16us 每 1us 一个桶，之后每个 2 的幂区间分为 8 个桶，相对误差不超过 12.5%
+struct FrameStats
+{
+    static constexpr size_t SUB_BUCKET_BITS = 3;
+    static constexpr size_t BUCKETS = 240; // 最大约 1 小时
+
+    uint64_t Frames;
+    uint64_t MissedFrames;    // Application：因循环阻塞而跳过的帧，按到期窗口各自的间隔计算；Window：OnUpdate 超过一帧的次数
+    uint64_t Events;          // 分发的事件总数
+    uint64_t Tasks;           // 执行的 Invoke 任务总数，只对 Application 有效
+    uint64_t LastFrameEvents; // 最近一帧期间分发的事件数
+    uint64_t LastFrameTasks;
+    uint64_t WakeUps; // 消息循环从等待中唤醒的次数，用于估算功耗，只对 Application 有效
+    std::chrono::nanoseconds UpdateTime;   // 消息泵、任务和定时器，只对 Application 有效
+    std::chrono::nanoseconds OnUpdateTime; // 所有 OnUpdate
+    std::chrono::nanoseconds SleepTime;    // 只对 Application 有效
+    std::chrono::nanoseconds MaxFrameTime;
+    uint64_t Histogram[BUCKETS];
+
+    static size_t BucketIndex(uint64_t us);
+
+    static std::chrono::microseconds BucketLowerBound(size_t index);
+
+    // p 为 0 到 1 之间的比例，返回所在桶的下界
+    std::chrono::microseconds Percentile(double p) const;
+};
+
+// 单写多读：只由拥有者的线程写入，任何线程都可以无锁读取快照
+class FrameStatsRecorder
+{
+public:
+    // 关联事件队列时由消费线程调用，与所属线程的同步事件并发
+    void AddEvent() { events.fetch_add(1, std::memory_order_relaxed); }
+
+    void AddTasks(uint64_t count) { Increase(tasks, count); }
+
+    void AddUpdateTime(std::chrono::nanoseconds time) { Increase(updateTime, time.count()); }
+
+    void AddOnUpdateTime(std::chrono::nanoseconds time) { Increase(onUpdateTime, time.count()); }
+
+    void AddSleepTime(std::chrono::nanoseconds time) { Increase(sleepTime, time.count()); }
+
+    void AddMissedFrames(uint64_t count) { Increase(missedFrames, count); }
+
+    void AddWakeUp() { Increase(wakeUps); }
+
+    // 一帧结束时调用，frameTime 为这一帧的工作时间
+    void RecordFrame(std::chrono::nanoseconds frameTime);
+
+    FrameStats Snapshot() const;
+
+private:
+    template <typename T>
+    static void Increase(std::atomic<T>& value, T delta = 1)
+    {
+        // 只有一个写线程，不需要原子的读-改-写
+        value.store(value.load(std::memory_order_relaxed) + delta, std::memory_order_relaxed);
+    }
+
+    std::atomic<uint64_t> frames = 0;
+    std::atomic<uint64_t> missedFrames = 0;
+    std::atomic<uint64_t> events = 0;
+    std::atomic<uint64_t> tasks = 0;
+    std::atomic<uint64_t> lastFrameEvents = 0;
+    std::atomic<uint64_t> lastFrameTasks = 0;
+    std::atomic<uint64_t> wakeUps = 0;
+    std::atomic<int64_t> updateTime = 0;
+    std::atomic<int64_t> onUpdateTime = 0;
+    std::atomic<int64_t> sleepTime = 0;
+    std::atomic<int64_t> maxFrameTime = 0;
+    std::atomic<uint64_t> histogram[FrameStats::BUCKETS] = {};
+    uint64_t frameEventsStart = 0;
+    uint64_t frameTasksStart = 0;
+};
+} // namespace tk
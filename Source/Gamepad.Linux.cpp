@@ -0,0 +1,430 @@
+#if defined(__linux__)
+#include <linux/input.h>
+#include <sys/inotify.h>
+#include <sys/ioctl.h>
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <atomic>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include "Gamepad.h"
+
+using namespace tk;
+
+extern void GamepadPublish(int32_t index, const GamepadState& state);
+
+static bool TestBit(const uint8_t* bits, int32_t bit)
+{
+    return (bits[bit / 8] & (1 << (bit % 8))) != 0;
+}
+
+static int32_t TranslateButton(uint16_t code)
+{
+    switch (code)
+    {
+        case BTN_A:
+            return (int32_t)Keys::GamepadA;
+        case BTN_B:
+            return (int32_t)Keys::GamepadB;
+        case BTN_X:
+            return (int32_t)Keys::GamepadX;
+        case BTN_Y:
+            return (int32_t)Keys::GamepadY;
+        case BTN_THUMBL:
+            return (int32_t)Keys::GamepadThumbL;
+        case BTN_THUMBR:
+            return (int32_t)Keys::GamepadThumbR;
+        case BTN_TL:
+            return (int32_t)Keys::GamepadShoulderL;
+        case BTN_TR:
+            return (int32_t)Keys::GamepadShoulderR;
+        case BTN_DPAD_UP:
+            return (int32_t)Keys::GamepadUp;
+        case BTN_DPAD_DOWN:
+            return (int32_t)Keys::GamepadDown;
+        case BTN_DPAD_LEFT:
+            return (int32_t)Keys::GamepadLeft;
+        case BTN_DPAD_RIGHT:
+            return (int32_t)Keys::GamepadRight;
+        case BTN_SELECT:
+            return (int32_t)Keys::GamepadBack;
+        case BTN_START:
+            return (int32_t)Keys::GamepadStart;
+        case BTN_MODE:
+            return (int32_t)Keys::GamepadGuide;
+    }
+    return -1;
+}
+
+static int32_t TranslateAxis(uint16_t code)
+{
+    switch (code)
+    {
+        case ABS_X:
+            return (int32_t)GamepadAxis::LeftX;
+        case ABS_Y:
+            return (int32_t)GamepadAxis::LeftY;
+        case ABS_RX:
+            return (int32_t)GamepadAxis::RightX;
+        case ABS_RY:
+            return (int32_t)GamepadAxis::RightY;
+        case ABS_Z:
+            return (int32_t)GamepadAxis::LeftTrigger;
+        case ABS_RZ:
+            return (int32_t)GamepadAxis::RightTrigger;
+    }
+    return -1;
+}
+
+static void SetButton(GamepadState& state, Keys key, bool pressed)
+{
+    uint32_t mask = 1u << ((int32_t)key - (int32_t)Keys::GamepadA);
+    if (pressed)
+        state.Buttons |= mask;
+    else
+        state.Buttons &= ~mask;
+}
+
+static const uint16_t buttonCodes[] = {BTN_A, BTN_B, BTN_X, BTN_Y, BTN_THUMBL, BTN_THUMBR, BTN_TL, BTN_TR, BTN_DPAD_UP, BTN_DPAD_DOWN, BTN_DPAD_LEFT, BTN_DPAD_RIGHT, BTN_SELECT, BTN_START, BTN_MODE};
+static const uint16_t axisCodes[] = {ABS_X, ABS_Y, ABS_RX, ABS_RY, ABS_Z, ABS_RZ};
+
+GamepadEvdevReader::GamepadEvdevReader(int fd)
+    : fd(fd)
+{
+    pending.Connected = true;
+    state.Connected = true;
+
+    // 管道等非设备 fd 的 ioctl 会失败，此时使用 xpad 的默认范围
+    SetAxisRange(ABS_X, -32768, 32767);
+    SetAxisRange(ABS_Y, -32768, 32767);
+    SetAxisRange(ABS_RX, -32768, 32767);
+    SetAxisRange(ABS_RY, -32768, 32767);
+    SetAxisRange(ABS_Z, 0, 255);
+    SetAxisRange(ABS_RZ, 0, 255);
+
+    for (auto code : axisCodes)
+    {
+        input_absinfo info;
+        if (ioctl(fd, EVIOCGABS(code), &info) == 0 && info.maximum > info.minimum)
+            SetAxisRange(code, info.minimum, info.maximum);
+    }
+}
+
+void GamepadEvdevReader::SetAxisRange(uint16_t code, int32_t minimum, int32_t maximum)
+{
+    int32_t axis = TranslateAxis(code);
+    if (axis < 0 || maximum <= minimum)
+        return;
+
+    ranges[axis] = {minimum, maximum};
+}
+
+bool GamepadEvdevReader::Read()
+{
+    ssize_t n;
+    do
+    {
+        n = read(fd, buffer + buffered, sizeof(buffer) - buffered);
+    } while (n < 0 && errno == EINTR);
+
+    if (n < 0)
+        return errno == EAGAIN || errno == EWOULDBLOCK;
+
+    if (n == 0)
+        return false;
+
+    buffered += (size_t)n;
+
+    size_t offset = 0;
+    while (buffered - offset >= sizeof(input_event))
+    {
+        input_event ev;
+        memcpy(&ev, buffer + offset, sizeof(ev));
+        offset += sizeof(ev);
+        Process(ev.type, ev.code, ev.value);
+    }
+
+    buffered -= offset;
+    if (buffered > 0)
+        memmove(buffer, buffer + offset, buffered);
+
+    return true;
+}
+
+void GamepadEvdevReader::Process(uint16_t type, uint16_t code, int32_t value)
+{
+    if (type == EV_SYN)
+    {
+        if (code == SYN_DROPPED)
+        {
+            dropped = true;
+        }
+        else if (code == SYN_REPORT)
+        {
+            if (dropped)
+            {
+                dropped = false;
+                Resync();
+            }
+            pending.PacketNumber++;
+            state = pending;
+        }
+        return;
+    }
+
+    // SYN_DROPPED 之后直到下一个 SYN_REPORT 的事件都不可信
+    if (dropped)
+        return;
+
+    if (type == EV_KEY)
+    {
+        int32_t key = TranslateButton(code);
+        if (key >= 0)
+            SetButton(pending, (Keys)key, value != 0);
+    }
+    else if (type == EV_ABS)
+    {
+        if (code == ABS_HAT0X)
+        {
+            SetButton(pending, Keys::GamepadLeft, value < 0);
+            SetButton(pending, Keys::GamepadRight, value > 0);
+            return;
+        }
+
+        if (code == ABS_HAT0Y)
+        {
+            SetButton(pending, Keys::GamepadUp, value < 0);
+            SetButton(pending, Keys::GamepadDown, value > 0);
+            return;
+        }
+
+        int32_t axis = TranslateAxis(code);
+        if (axis < 0)
+            return;
+
+        auto& range = ranges[axis];
+        float t = (float)((double)value - range.Minimum) / (float)((double)range.Maximum - range.Minimum);
+        t = t < 0 ? 0 : (t > 1 ? 1 : t);
+
+        if (axis == (int32_t)GamepadAxis::LeftTrigger || axis == (int32_t)GamepadAxis::RightTrigger)
+            pending.Axes[axis] = t;
+        else if (axis == (int32_t)GamepadAxis::LeftY || axis == (int32_t)GamepadAxis::RightY)
+            pending.Axes[axis] = 1.f - t * 2.f; // evdev 的 Y 轴向下为正
+        else
+            pending.Axes[axis] = t * 2.f - 1.f;
+    }
+}
+
+void GamepadEvdevReader::Resync()
+{
+    uint8_t keys[(KEY_MAX + 7) / 8] = {};
+    if (ioctl(fd, EVIOCGKEY(sizeof(keys)), keys) >= 0)
+    {
+        for (auto code : buttonCodes)
+            SetButton(pending, (Keys)TranslateButton(code), TestBit(keys, code));
+    }
+
+    for (auto code : axisCodes)
+    {
+        input_absinfo info;
+        if (ioctl(fd, EVIOCGABS(code), &info) == 0)
+            Process(EV_ABS, code, info.value);
+    }
+}
+
+namespace
+{
+struct EvdevDevice
+{
+    std::string path;
+    int32_t index;
+    std::unique_ptr<GamepadEvdevReader> reader;
+    uint32_t published;
+};
+} // namespace
+
+static std::thread gamepadThread;
+static std::atomic<bool> gamepadThreadRunning = false;
+static int gamepadWakePipe[2] = {-1, -1};
+
+static bool IsGamepadDevice(int fd)
+{
+    uint8_t keys[(KEY_MAX + 7) / 8] = {};
+    if (ioctl(fd, EVIOCGBIT(EV_KEY, sizeof(keys)), keys) < 0)
+        return false;
+
+    return TestBit(keys, BTN_GAMEPAD);
+}
+
+static void ScanDevices(std::vector<EvdevDevice>& devices)
+{
+    DIR* dir = opendir("/dev/input");
+    if (dir == nullptr)
+        return;
+
+    while (auto entry = readdir(dir))
+    {
+        if (strncmp(entry->d_name, "event", 5) != 0)
+            continue;
+
+        std::string path = std::string("/dev/input/") + entry->d_name;
+
+        bool opened = false;
+        for (auto& device : devices)
+            opened |= device.path == path;
+
+        if (opened || devices.size() >= MAX_GAMEPADS)
+            continue;
+
+        int fd = open(path.c_str(), O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+        if (fd < 0)
+            continue;
+
+        if (!IsGamepadDevice(fd))
+        {
+            close(fd);
+            continue;
+        }
+
+        int32_t index = 0;
+        for (; index < MAX_GAMEPADS; index++)
+        {
+            bool used = false;
+            for (auto& device : devices)
+                used |= device.index == index;
+            if (!used)
+                break;
+        }
+
+        EvdevDevice device;
+        device.path = path;
+        device.index = index;
+        device.reader = std::make_unique<GamepadEvdevReader>(fd);
+        device.published = device.reader->GetState().PacketNumber;
+        GamepadPublish(index, device.reader->GetState());
+        devices.push_back(std::move(device));
+    }
+
+    closedir(dir);
+}
+
+static void CloseDevice(EvdevDevice& device)
+{
+    close(device.reader->GetFd());
+    GamepadPublish(device.index, GamepadState{});
+}
+
+static void GamepadThreadProc()
+{
+    std::vector<EvdevDevice> devices;
+
+    // 用 inotify 监听热插拔，避免周期性扫描目录
+    int notify = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (notify >= 0 && inotify_add_watch(notify, "/dev/input", IN_CREATE | IN_ATTRIB) < 0)
+    {
+        close(notify);
+        notify = -1;
+    }
+
+    ScanDevices(devices);
+
+    std::vector<pollfd> fds;
+    while (gamepadThreadRunning.load())
+    {
+        fds.clear();
+        fds.push_back({gamepadWakePipe[0], POLLIN, 0});
+        fds.push_back({notify, POLLIN, 0});
+        for (auto& device : devices)
+            fds.push_back({device.reader->GetFd(), POLLIN, 0});
+
+        int ret = poll(fds.data(), (nfds_t)fds.size(), notify >= 0 ? -1 : 1000);
+        if (ret < 0 && errno != EINTR)
+            break;
+
+        if (fds[0].revents != 0)
+        {
+            char buf[64];
+            while (read(gamepadWakePipe[0], buf, sizeof(buf)) > 0)
+                ;
+        }
+
+        bool rescan = notify < 0;
+        if (fds[1].revents != 0)
+        {
+            char buf[4096];
+            while (read(notify, buf, sizeof(buf)) > 0)
+                ;
+            rescan = true;
+        }
+
+        for (size_t i = 0, j = 2; i < devices.size(); j++)
+        {
+            auto& device = devices[i];
+            auto revents = fds[j].revents;
+
+            bool alive = true;
+            if (revents & POLLIN)
+                alive = device.reader->Read();
+            else if (revents & (POLLERR | POLLHUP | POLLNVAL))
+                alive = false;
+
+            if (!alive)
+            {
+                CloseDevice(device);
+                devices.erase(devices.begin() + i);
+                continue;
+            }
+
+            auto& state = device.reader->GetState();
+            if (state.PacketNumber != device.published)
+            {
+                device.published = state.PacketNumber;
+                GamepadPublish(device.index, state);
+            }
+            i++;
+        }
+
+        if (rescan)
+            ScanDevices(devices);
+    }
+
+    for (auto& device : devices)
+        CloseDevice(device);
+
+    if (notify >= 0)
+        close(notify);
+}
+
+bool GamepadBackendStart()
+{
+    if (pipe2(gamepadWakePipe, O_NONBLOCK | O_CLOEXEC) != 0)
+        return false;
+
+    gamepadThreadRunning = true;
+    gamepadThread = std::thread(GamepadThreadProc);
+    return true;
+}
+
+void GamepadBackendStop()
+{
+    gamepadThreadRunning = false;
+    if (gamepadWakePipe[1] >= 0)
+    {
+        char c = 0;
+        [[maybe_unused]] auto n = write(gamepadWakePipe[1], &c, 1);
+    }
+
+    if (gamepadThread.joinable())
+        gamepadThread.join();
+
+    close(gamepadWakePipe[0]);
+    close(gamepadWakePipe[1]);
+    gamepadWakePipe[0] = gamepadWakePipe[1] = -1;
+}
+#endif
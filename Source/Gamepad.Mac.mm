@@ -0,0 +1,152 @@
+#if defined(__APPLE__)
+#include "TargetConditionals.h"
+#if defined(TARGET_OS_MAC)
+
+#import <Foundation/Foundation.h>
+#import <GameController/GameController.h>
+#include "Gamepad.h"
+
+using namespace tk;
+
+extern void GamepadPublish(int32_t index, const GamepadState& state);
+
+// 所有手柄状态都在这个串行队列上读取和发布，不占用主线程
+static dispatch_queue_t gamepadQueue = nil;
+static GCController* gamepadSlots[MAX_GAMEPADS] = {};
+static uint32_t gamepadPackets[MAX_GAMEPADS] = {};
+static id gamepadConnectObserver = nil;
+static id gamepadDisconnectObserver = nil;
+
+static void SetButton(GamepadState& state, Keys key, GCControllerButtonInput* button)
+{
+    if (button != nil && [button isPressed])
+        state.Buttons |= 1u << ((int32_t)key - (int32_t)Keys::GamepadA);
+}
+
+static void PublishGamepad(int32_t index, GCExtendedGamepad* pad)
+{
+    GamepadState state;
+    state.Connected = true;
+    state.PacketNumber = ++gamepadPackets[index];
+
+    SetButton(state, Keys::GamepadA, pad.buttonA);
+    SetButton(state, Keys::GamepadB, pad.buttonB);
+    SetButton(state, Keys::GamepadX, pad.buttonX);
+    SetButton(state, Keys::GamepadY, pad.buttonY);
+    SetButton(state, Keys::GamepadShoulderL, pad.leftShoulder);
+    SetButton(state, Keys::GamepadShoulderR, pad.rightShoulder);
+    SetButton(state, Keys::GamepadThumbL, pad.leftThumbstickButton);
+    SetButton(state, Keys::GamepadThumbR, pad.rightThumbstickButton);
+    SetButton(state, Keys::GamepadUp, pad.dpad.up);
+    SetButton(state, Keys::GamepadDown, pad.dpad.down);
+    SetButton(state, Keys::GamepadLeft, pad.dpad.left);
+    SetButton(state, Keys::GamepadRight, pad.dpad.right);
+    if (@available(macOS 10.15, *))
+    {
+        SetButton(state, Keys::GamepadBack, pad.buttonOptions);
+        SetButton(state, Keys::GamepadStart, pad.buttonMenu);
+    }
+    if (@available(macOS 11.0, *))
+    {
+        SetButton(state, Keys::GamepadGuide, pad.buttonHome);
+    }
+
+    state.Axes[(int32_t)GamepadAxis::LeftX] = pad.leftThumbstick.xAxis.value;
+    state.Axes[(int32_t)GamepadAxis::LeftY] = pad.leftThumbstick.yAxis.value;
+    state.Axes[(int32_t)GamepadAxis::RightX] = pad.rightThumbstick.xAxis.value;
+    state.Axes[(int32_t)GamepadAxis::RightY] = pad.rightThumbstick.yAxis.value;
+    state.Axes[(int32_t)GamepadAxis::LeftTrigger] = pad.leftTrigger.value;
+    state.Axes[(int32_t)GamepadAxis::RightTrigger] = pad.rightTrigger.value;
+
+    GamepadPublish(index, state);
+}
+
+static void AttachController(GCController* controller)
+{
+    dispatch_async(gamepadQueue, ^{
+        if (controller.extendedGamepad == nil)
+            return;
+
+        int32_t index = -1;
+        for (int32_t i = 0; i < MAX_GAMEPADS; i++)
+        {
+            if (gamepadSlots[i] == controller)
+                return;
+            if (index < 0 && gamepadSlots[i] == nil)
+                index = i;
+        }
+
+        if (index < 0)
+            return;
+
+        gamepadSlots[index] = controller;
+        controller.handlerQueue = gamepadQueue;
+        controller.extendedGamepad.valueChangedHandler = ^(GCExtendedGamepad* pad, GCControllerElement* element) {
+          PublishGamepad(index, pad);
+        };
+        PublishGamepad(index, controller.extendedGamepad);
+    });
+}
+
+static void DetachController(GCController* controller)
+{
+    dispatch_async(gamepadQueue, ^{
+        for (int32_t i = 0; i < MAX_GAMEPADS; i++)
+        {
+            if (gamepadSlots[i] == controller)
+            {
+                controller.extendedGamepad.valueChangedHandler = nil;
+                gamepadSlots[i] = nil;
+                GamepadPublish(i, GamepadState{});
+            }
+        }
+    });
+}
+
+bool GamepadBackendStart()
+{
+    gamepadQueue = dispatch_queue_create("tk.gamepad", DISPATCH_QUEUE_SERIAL);
+
+    NSNotificationCenter* center = [NSNotificationCenter defaultCenter];
+    gamepadConnectObserver = [center addObserverForName:GCControllerDidConnectNotification
+                                                 object:nil
+                                                  queue:nil
+                                             usingBlock:^(NSNotification* note) {
+                                               AttachController((GCController*)note.object);
+                                             }];
+    gamepadDisconnectObserver = [center addObserverForName:GCControllerDidDisconnectNotification
+                                                    object:nil
+                                                     queue:nil
+                                                usingBlock:^(NSNotification* note) {
+                                                  DetachController((GCController*)note.object);
+                                                }];
+
+    for (GCController* controller in [GCController controllers])
+        AttachController(controller);
+
+    return true;
+}
+
+void GamepadBackendStop()
+{
+    NSNotificationCenter* center = [NSNotificationCenter defaultCenter];
+    [center removeObserver:gamepadConnectObserver];
+    [center removeObserver:gamepadDisconnectObserver];
+    gamepadConnectObserver = nil;
+    gamepadDisconnectObserver = nil;
+
+    dispatch_sync(gamepadQueue, ^{
+        for (int32_t i = 0; i < MAX_GAMEPADS; i++)
+        {
+            if (gamepadSlots[i] != nil)
+            {
+                gamepadSlots[i].extendedGamepad.valueChangedHandler = nil;
+                gamepadSlots[i] = nil;
+                GamepadPublish(i, GamepadState{});
+            }
+        }
+    });
+    gamepadQueue = nil;
+}
+#endif
+#endif
@@ -0,0 +1,121 @@
+#ifdef _WIN32
+#include <Windows.h>
+#include <Xinput.h>
+#include <algorithm>
+#include <thread>
+#include "Gamepad.h"
+
+using namespace tk;
+
+extern void GamepadPublish(int32_t index, const GamepadState& state);
+
+struct TranslateGamepadButton
+{
+    WORD m_mask;
+    Keys m_key;
+};
+
+static const TranslateGamepadButton s_translateGamepadButtons[] =
+    {
+        {XINPUT_GAMEPAD_A, Keys::GamepadA},
+        {XINPUT_GAMEPAD_B, Keys::GamepadB},
+        {XINPUT_GAMEPAD_X, Keys::GamepadX},
+        {XINPUT_GAMEPAD_Y, Keys::GamepadY},
+        {XINPUT_GAMEPAD_LEFT_THUMB, Keys::GamepadThumbL},
+        {XINPUT_GAMEPAD_RIGHT_THUMB, Keys::GamepadThumbR},
+        {XINPUT_GAMEPAD_LEFT_SHOULDER, Keys::GamepadShoulderL},
+        {XINPUT_GAMEPAD_RIGHT_SHOULDER, Keys::GamepadShoulderR},
+        {XINPUT_GAMEPAD_DPAD_UP, Keys::GamepadUp},
+        {XINPUT_GAMEPAD_DPAD_DOWN, Keys::GamepadDown},
+        {XINPUT_GAMEPAD_DPAD_LEFT, Keys::GamepadLeft},
+        {XINPUT_GAMEPAD_DPAD_RIGHT, Keys::GamepadRight},
+        {XINPUT_GAMEPAD_BACK, Keys::GamepadBack},
+        {XINPUT_GAMEPAD_START, Keys::GamepadStart},
+};
+
+static std::thread gamepadThread;
+static HANDLE gamepadStopEvent = NULL;
+
+static float NormalizeThumb(SHORT value)
+{
+    return std::clamp(value / 32767.f, -1.f, 1.f);
+}
+
+static void GamepadThreadProc()
+{
+    bool connected[MAX_GAMEPADS] = {};
+    DWORD packets[MAX_GAMEPADS] = {};
+    ULONGLONG nextProbe[MAX_GAMEPADS] = {};
+
+    // XInput 没有事件通知，只能轮询；空槽位的查询很慢，所以每秒只探测一次
+    while (WaitForSingleObject(gamepadStopEvent, 8) == WAIT_TIMEOUT)
+    {
+        ULONGLONG now = GetTickCount64();
+        for (DWORD i = 0; i < MAX_GAMEPADS; i++)
+        {
+            if (!connected[i] && now < nextProbe[i])
+                continue;
+
+            XINPUT_STATE xs;
+            ZeroMemory(&xs, sizeof(xs));
+            if (XInputGetState(i, &xs) != ERROR_SUCCESS)
+            {
+                if (connected[i])
+                    GamepadPublish(i, GamepadState{});
+
+                connected[i] = false;
+                nextProbe[i] = now + 1000;
+                continue;
+            }
+
+            if (connected[i] && xs.dwPacketNumber == packets[i])
+                continue;
+
+            connected[i] = true;
+            packets[i] = xs.dwPacketNumber;
+
+            GamepadState state;
+            state.Connected = true;
+            state.PacketNumber = xs.dwPacketNumber;
+            for (auto&& button : s_translateGamepadButtons)
+            {
+                if (xs.Gamepad.wButtons & button.m_mask)
+                    state.Buttons |= 1u << ((int32_t)button.m_key - (int32_t)Keys::GamepadA);
+            }
+            state.Axes[(int32_t)GamepadAxis::LeftX] = NormalizeThumb(xs.Gamepad.sThumbLX);
+            state.Axes[(int32_t)GamepadAxis::LeftY] = NormalizeThumb(xs.Gamepad.sThumbLY);
+            state.Axes[(int32_t)GamepadAxis::RightX] = NormalizeThumb(xs.Gamepad.sThumbRX);
+            state.Axes[(int32_t)GamepadAxis::RightY] = NormalizeThumb(xs.Gamepad.sThumbRY);
+            state.Axes[(int32_t)GamepadAxis::LeftTrigger] = xs.Gamepad.bLeftTrigger / 255.f;
+            state.Axes[(int32_t)GamepadAxis::RightTrigger] = xs.Gamepad.bRightTrigger / 255.f;
+            GamepadPublish(i, state);
+        }
+    }
+
+    for (DWORD i = 0; i < MAX_GAMEPADS; i++)
+    {
+        if (connected[i])
+            GamepadPublish(i, GamepadState{});
+    }
+}
+
+bool GamepadBackendStart()
+{
+    gamepadStopEvent = CreateEvent(NULL, TRUE, FALSE, NULL);
+    if (gamepadStopEvent == NULL)
+        return false;
+
+    gamepadThread = std::thread(GamepadThreadProc);
+    return true;
+}
+
+void GamepadBackendStop()
+{
+    SetEvent(gamepadStopEvent);
+    if (gamepadThread.joinable())
+        gamepadThread.join();
+
+    CloseHandle(gamepadStopEvent);
+    gamepadStopEvent = NULL;
+}
+#endif
@@ -0,0 +1,171 @@
+#include <atomic>
+#include <algorithm>
+#include <cmath>
+#include "Gamepad.h"
+#include "SeqLock.h"
+
+using namespace tk;
+
+namespace tk
+{
+void DispatchEvent(Window* win, Event* e);
+}
+
+extern Window* GetFocusedWindow();
+extern bool GamepadBackendStart();
+extern void GamepadBackendStop();
+
+static SeqLock<GamepadState> gamepadStates[MAX_GAMEPADS];
+// 每个 UI 线程各自检测按键沿，事件只发给本线程中拥有焦点的窗口
+static thread_local GamepadState gamepadLastStates[MAX_GAMEPADS];
+static thread_local uint64_t gamepadLastSequences[MAX_GAMEPADS] = {};
+static thread_local uint32_t gamepadLastGeneration = 0;
+// 每次 Stop 递增，各 UI 线程在下一次轮询时丢弃自己记录的按键状态
+static std::atomic<uint32_t> gamepadGeneration = 0;
+static std::atomic<bool> gamepadRunning = false;
+static std::atomic<float> gamepadStickDeadzone = 0.24f;
+static std::atomic<float> gamepadTriggerDeadzone = 0.12f;
+
+static void ApplyStickDeadzone(float& x, float& y, float deadzone)
+{
+    float magnitude = std::sqrt(x * x + y * y);
+    if (magnitude <= deadzone)
+    {
+        x = 0;
+        y = 0;
+        return;
+    }
+
+    float scale = ((std::min)(magnitude, 1.f) - deadzone) / (1.f - deadzone) / magnitude;
+    x *= scale;
+    y *= scale;
+}
+
+static float ApplyTriggerDeadzone(float value, float deadzone)
+{
+    if (value <= deadzone)
+        return 0;
+
+    return ((std::min)(value, 1.f) - deadzone) / (1.f - deadzone);
+}
+
+// 由后端线程调用
+void GamepadPublish(int32_t index, const GamepadState& raw)
+{
+    if (index < 0 || index >= MAX_GAMEPADS)
+        return;
+
+    GamepadState state = raw;
+    float stick = gamepadStickDeadzone.load(std::memory_order_relaxed);
+    float trigger = gamepadTriggerDeadzone.load(std::memory_order_relaxed);
+    ApplyStickDeadzone(state.Axes[(int32_t)GamepadAxis::LeftX], state.Axes[(int32_t)GamepadAxis::LeftY], stick);
+    ApplyStickDeadzone(state.Axes[(int32_t)GamepadAxis::RightX], state.Axes[(int32_t)GamepadAxis::RightY], stick);
+    state.Axes[(int32_t)GamepadAxis::LeftTrigger] = ApplyTriggerDeadzone(state.Axes[(int32_t)GamepadAxis::LeftTrigger], trigger);
+    state.Axes[(int32_t)GamepadAxis::RightTrigger] = ApplyTriggerDeadzone(state.Axes[(int32_t)GamepadAxis::RightTrigger], trigger);
+    if (!state.Connected)
+        state.Buttons = 0;
+
+    gamepadStates[index].Store(state);
+}
+
+// 每帧在主线程调用，把按键沿转换为 KeyDown/KeyUp
+void PollGamepads()
+{
+    if (!gamepadRunning.load(std::memory_order_relaxed))
+        return;
+
+    auto generation = gamepadGeneration.load(std::memory_order_acquire);
+    if (generation != gamepadLastGeneration)
+    {
+        gamepadLastGeneration = generation;
+        for (int32_t i = 0; i < MAX_GAMEPADS; i++)
+        {
+            gamepadLastStates[i] = GamepadState{};
+            gamepadLastSequences[i] = 0;
+        }
+    }
+
+    Window* focused = nullptr;
+    bool queried = false;
+
+    for (int32_t i = 0; i < MAX_GAMEPADS; i++)
+    {
+        auto sequence = gamepadStates[i].GetSequence();
+        if (sequence == gamepadLastSequences[i])
+            continue;
+
+        gamepadLastSequences[i] = sequence;
+
+        GamepadState state = gamepadStates[i].Load();
+        uint32_t changed = state.Buttons ^ gamepadLastStates[i].Buttons;
+        gamepadLastStates[i] = state;
+
+        if (changed == 0)
+            continue;
+
+        if (!queried)
+        {
+            focused = GetFocusedWindow();
+            queried = true;
+        }
+
+        if (focused == nullptr)
+            continue;
+
+        for (uint32_t bit = 0; changed != 0; bit++, changed >>= 1)
+        {
+            if ((changed & 1) == 0)
+                continue;
+
+            KeyEvent e;
+            e.type = (state.Buttons & (1u << bit)) != 0 ? EventType::KeyDown : EventType::KeyUp;
+            e.Modifier = ModifierKey::None;
+            e.Key = (Keys)((int32_t)Keys::GamepadA + bit);
+            DispatchEvent(focused, &e);
+        }
+    }
+}
+
+bool Gamepad::Start()
+{
+    if (gamepadRunning.load())
+        return true;
+
+    if (!GamepadBackendStart())
+        return false;
+
+    gamepadRunning = true;
+    return true;
+}
+
+void Gamepad::Stop()
+{
+    if (!gamepadRunning.exchange(false))
+        return;
+
+    GamepadBackendStop();
+
+    for (int32_t i = 0; i < MAX_GAMEPADS; i++)
+        gamepadStates[i].Store(GamepadState{});
+    gamepadGeneration.fetch_add(1, std::memory_order_release);
+}
+
+bool Gamepad::IsRunning()
+{
+    return gamepadRunning.load();
+}
+
+bool Gamepad::GetState(int32_t index, GamepadState* state)
+{
+    if (index < 0 || index >= MAX_GAMEPADS || state == nullptr)
+        return false;
+
+    *state = gamepadStates[index].Load();
+    return state->Connected;
+}
+
+void Gamepad::SetDeadzone(float stick, float trigger)
+{
+    gamepadStickDeadzone = std::clamp(stick, 0.f, 0.99f);
+    gamepadTriggerDeadzone = std::clamp(trigger, 0.f, 0.99f);
+}
@@ -0,0 +1,91 @@
+#pragma once
+#include <stdint.h>
+#include "Window.h"
+
+namespace tk
+{
+constexpr int32_t MAX_GAMEPADS = 4;
+
+enum class GamepadAxis
+{
+    LeftX,
+    LeftY,
+    RightX,
+    RightY,
+    LeftTrigger,
+    RightTrigger,
+    Count
+};
+
+// 摇杆范围 [-1, 1]，Y 轴向上为正；扳机范围 [0, 1]
+struct GamepadState
+{
+    bool Connected = false;
+    uint32_t Buttons = 0;
+    uint32_t PacketNumber = 0;
+    float Axes[(int32_t)GamepadAxis::Count] = {};
+
+    bool IsPressed(Keys key) const
+    {
+        int32_t bit = (int32_t)key - (int32_t)Keys::GamepadA;
+        return bit >= 0 && bit <= (int32_t)Keys::GamepadGuide - (int32_t)Keys::GamepadA && (Buttons & (1u << bit)) != 0;
+    }
+
+    float GetAxis(GamepadAxis axis) const
+    {
+        return Axes[(int32_t)axis];
+    }
+};
+
+class Gamepad
+{
+public:
+    // 启动后台线程读取手柄，按键变化会作为 KeyDown/KeyUp 发送给当前焦点窗口
+    static bool Start();
+
+    static void Stop();
+
+    static bool IsRunning();
+
+    static bool GetState(int32_t index, GamepadState* state);
+
+    static void SetDeadzone(float stick, float trigger);
+};
+
+#if defined(__linux__)
+// 解析 evdev input_event 流，fd 可以是设备节点也可以是管道
+class GamepadEvdevReader
+{
+public:
+    explicit GamepadEvdevReader(int fd);
+
+    // 执行一次 read()，返回 false 表示 EOF 或设备已移除
+    bool Read();
+
+    void SetAxisRange(uint16_t code, int32_t minimum, int32_t maximum);
+
+    int GetFd() const { return fd; }
+
+    const GamepadState& GetState() const { return state; }
+
+private:
+    void Process(uint16_t type, uint16_t code, int32_t value);
+
+    void Resync();
+
+    struct AxisRange
+    {
+        int32_t Minimum;
+        int32_t Maximum;
+    };
+
+    int fd;
+    bool dropped = false;
+    GamepadState pending;
+    GamepadState state;
+    AxisRange ranges[(int32_t)GamepadAxis::Count];
+    uint8_t buffer[4096];
+    size_t buffered = 0;
+};
+#endif
+} // namespace tk
@@ -0,0 +1,65 @@
+#pragma once
+#include <atomic>
+#include <cstring>
+#include <type_traits>
+#include <stdint.h>
+
+namespace tk
+{
+// 单写多读的顺序锁：写线程发布快照，任意线程无锁读取
+template <typename T>
+class SeqLock
+{
+    static_assert(std::is_trivially_copyable_v<T>, "SeqLock requires a trivially copyable type");
+
+    static constexpr size_t WORDS = (sizeof(T) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+
+public:
+    SeqLock()
+    {
+        Store(T{});
+    }
+
+    // 只能由唯一的写线程调用
+    void Store(const T& value)
+    {
+        uint64_t words[WORDS] = {};
+        memcpy(words, &value, sizeof(T));
+
+        auto seq = sequence.load(std::memory_order_relaxed);
+        sequence.store(seq + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        for (size_t i = 0; i < WORDS; i++)
+            data[i].store(words[i], std::memory_order_relaxed);
+        sequence.store(seq + 2, std::memory_order_release);
+    }
+
+    T Load() const
+    {
+        uint64_t words[WORDS];
+        uint64_t begin, end;
+        do
+        {
+            begin = sequence.load(std::memory_order_acquire);
+            for (size_t i = 0; i < WORDS; i++)
+                words[i] = data[i].load(std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            end = sequence.load(std::memory_order_relaxed);
+        } while ((begin & 1) != 0 || begin != end);
+
+        T value;
+        memcpy(&value, words, sizeof(T));
+        return value;
+    }
+
+    // 每次 Store 递增 2，可用于廉价地检测变化
+    uint64_t GetSequence() const
+    {
+        return sequence.load(std::memory_order_acquire);
+    }
+
+private:
+    std::atomic<uint64_t> sequence = 0;
+    std::atomic<uint64_t> data[WORDS];
+};
+} // namespace tk
@@ -0,0 +1,186 @@
+#if defined(__APPLE__)
+#include "TargetConditionals.h"
+#if defined(TARGET_OS_MAC)
+
+#import <Cocoa/Cocoa.h>
+#import <QuartzCore/CAMetalLayer.h>
+#include <dlfcn.h>
+#include "Surface.h"
+
+// NSOpenGL 已被标记为弃用，但仍是 macOS 上唯一的原生 OpenGL 接口
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wdeprecated-declarations"
+
+using namespace tk;
+
+namespace tk
+{
+struct NativeSurface
+{
+    NSView* view = nil;
+    NSOpenGLContext* context = nil;
+    CAMetalLayer* layer = nil;
+};
+} // namespace tk
+
+static NSOpenGLContext* CreateContext(NSView* view, const SurfaceDesc& desc)
+{
+    NSOpenGLPixelFormatAttribute profile = NSOpenGLProfileVersionLegacy;
+    if (desc.MajorVersion >= 4)
+        profile = NSOpenGLProfileVersion4_1Core;
+    else if (desc.MajorVersion == 3 && desc.MinorVersion >= 2)
+        profile = NSOpenGLProfileVersion3_2Core;
+
+    NSOpenGLPixelFormatAttribute attributes[] = {
+        NSOpenGLPFAOpenGLProfile, profile,
+        NSOpenGLPFADoubleBuffer,
+        NSOpenGLPFAAccelerated,
+        NSOpenGLPFAColorSize, 24,
+        NSOpenGLPFAAlphaSize, 8,
+        NSOpenGLPFADepthSize, (NSOpenGLPixelFormatAttribute)desc.DepthBits,
+        NSOpenGLPFAStencilSize, (NSOpenGLPixelFormatAttribute)desc.StencilBits,
+        0};
+
+    NSOpenGLPixelFormat* format = [[NSOpenGLPixelFormat alloc] initWithAttributes:attributes];
+    if (format == nil)
+        return nil;
+
+    NSOpenGLContext* context = [[NSOpenGLContext alloc] initWithFormat:format shareContext:nil];
+    if (context == nil)
+        return nil;
+
+    // 按像素而不是点分配帧缓冲
+    [view setWantsBestResolutionOpenGLSurface:YES];
+    [context setView:view];
+    return context;
+}
+
+bool Surface::CreateImpl()
+{
+    @autoreleasepool
+    {
+        NSWindow* nsWindow = (NSWindow*)window->GetHandle();
+        NSView* view = [nsWindow contentView];
+
+        native = new NativeSurface();
+        native->view = view;
+
+        if (desc.Api == SurfaceApi::OpenGL)
+        {
+            native->context = CreateContext(view, desc);
+            if (native->context == nil)
+            {
+                delete native;
+                native = nullptr;
+                return false;
+            }
+
+            [native->context makeCurrentContext];
+            SetSwapIntervalImpl(swapInterval);
+        }
+        else
+        {
+            // MoltenVK 通过 VK_EXT_metal_surface 在 CAMetalLayer 上呈现
+            native->layer = [[CAMetalLayer alloc] init];
+            [view setWantsLayer:YES];
+            [view setLayer:native->layer];
+            ResizeImpl();
+        }
+    }
+
+    return true;
+}
+
+void Surface::DestroyImpl()
+{
+    @autoreleasepool
+    {
+        if (native->context != nil)
+        {
+            if ([NSOpenGLContext currentContext] == native->context)
+                [NSOpenGLContext clearCurrentContext];
+            [native->context clearDrawable];
+        }
+
+        // 窗口可能被 WindowPool 复用，还原内容视图
+        if (native->layer != nil && [native->view layer] == native->layer)
+        {
+            [native->view setLayer:nil];
+            [native->view setWantsLayer:NO];
+        }
+    }
+
+    delete native;
+}
+
+void Surface::ResizeImpl()
+{
+    NSOpenGLContext* context = native->context;
+    CAMetalLayer* layer = native->layer;
+    NSView* view = native->view;
+    auto resize = ^{
+      if (context != nil)
+          [context update];
+
+      if (layer != nil)
+      {
+          NSRect bounds = [view bounds];
+          CGFloat scale = [[view window] backingScaleFactor];
+          [layer setContentsScale:scale];
+          [layer setDrawableSize:CGSizeMake(bounds.size.width * scale, bounds.size.height * scale)];
+      }
+    };
+
+    // 关联 EventQueue 时在消费线程收到 Resize，AppKit 对象只能在主线程修改；
+    // 主线程可能正在等待消费线程释放分发锁，不能同步等待
+    if ([NSThread isMainThread])
+        resize();
+    else
+        dispatch_async(dispatch_get_main_queue(), resize);
+}
+
+bool Surface::SetSwapIntervalImpl(int32_t interval)
+{
+    if (native->context == nil)
+        return false;
+
+    // 没有自适应同步
+    GLint value = interval < 0 ? 1 : interval;
+    [native->context setValues:&value forParameter:NSOpenGLContextParameterSwapInterval];
+    return true;
+}
+
+bool Surface::MakeCurrent()
+{
+    if (native == nullptr || native->context == nil)
+        return false;
+
+    [native->context makeCurrentContext];
+    return true;
+}
+
+void Surface::SwapBuffers()
+{
+    if (native != nullptr && native->context != nil)
+        [native->context flushBuffer];
+}
+
+void* Surface::GetProcAddress(const char* name) const
+{
+    return dlsym(RTLD_DEFAULT, name);
+}
+
+SurfaceHandles Surface::GetHandles() const
+{
+    SurfaceHandles handles;
+    if (native != nullptr)
+    {
+        handles.Window = native->view;
+        handles.Layer = native->layer;
+    }
+    return handles;
+}
+
+#pragma clang diagnostic pop
+#endif
+#endif
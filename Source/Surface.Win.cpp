@@ -0,0 +1,178 @@
+#ifdef _WIN32
+#include <Windows.h>
+#include <gl/GL.h>
+#include <string.h>
+#include "Surface.h"
+
+using namespace tk;
+
+#define WGL_CONTEXT_MAJOR_VERSION_ARB 0x2091
+#define WGL_CONTEXT_MINOR_VERSION_ARB 0x2092
+#define WGL_CONTEXT_PROFILE_MASK_ARB 0x9126
+#define WGL_CONTEXT_CORE_PROFILE_BIT_ARB 0x00000001
+
+typedef HGLRC(WINAPI* PFNWGLCREATECONTEXTATTRIBSARBPROC)(HDC hDC, HGLRC hShareContext, const int* attribList);
+typedef BOOL(WINAPI* PFNWGLSWAPINTERVALEXTPROC)(int interval);
+typedef const char*(WINAPI* PFNWGLGETEXTENSIONSSTRINGEXTPROC)();
+
+namespace tk
+{
+struct NativeSurface
+{
+    HWND hWnd = NULL;
+    HDC hdc = NULL;
+    HGLRC context = NULL;
+    PFNWGLSWAPINTERVALEXTPROC swapInterval = nullptr;
+    bool swapControlTear = false; // 支持负的交换间隔
+};
+} // namespace tk
+
+static bool CreateContext(NativeSurface* native, const SurfaceDesc& desc)
+{
+    native->hdc = GetDC(native->hWnd);
+    if (native->hdc == NULL)
+        return false;
+
+    // 像素格式只能设置一次，从 WindowPool 复用的窗口保留之前的格式
+    if (GetPixelFormat(native->hdc) == 0)
+    {
+        PIXELFORMATDESCRIPTOR pfd = {};
+        pfd.nSize = sizeof(pfd);
+        pfd.nVersion = 1;
+        pfd.dwFlags = PFD_DRAW_TO_WINDOW | PFD_SUPPORT_OPENGL | PFD_DOUBLEBUFFER;
+        pfd.iPixelType = PFD_TYPE_RGBA;
+        pfd.cColorBits = 32;
+        pfd.cAlphaBits = 8;
+        pfd.cDepthBits = (BYTE)desc.DepthBits;
+        pfd.cStencilBits = (BYTE)desc.StencilBits;
+        pfd.iLayerType = PFD_MAIN_PLANE;
+
+        int format = ChoosePixelFormat(native->hdc, &pfd);
+        if (format == 0 || !SetPixelFormat(native->hdc, format, &pfd))
+            return false;
+    }
+
+    // 先创建旧式上下文才能取得 wglCreateContextAttribsARB
+    HGLRC legacy = wglCreateContext(native->hdc);
+    if (legacy == NULL || !wglMakeCurrent(native->hdc, legacy))
+    {
+        if (legacy != NULL)
+            wglDeleteContext(legacy);
+        return false;
+    }
+
+    native->context = legacy;
+
+    auto createContextAttribs = (PFNWGLCREATECONTEXTATTRIBSARBPROC)wglGetProcAddress("wglCreateContextAttribsARB");
+    if (createContextAttribs != nullptr && (desc.MajorVersion > 3 || (desc.MajorVersion == 3 && desc.MinorVersion >= 2)))
+    {
+        const int attributes[] = {
+            WGL_CONTEXT_MAJOR_VERSION_ARB, desc.MajorVersion,
+            WGL_CONTEXT_MINOR_VERSION_ARB, desc.MinorVersion,
+            WGL_CONTEXT_PROFILE_MASK_ARB, WGL_CONTEXT_CORE_PROFILE_BIT_ARB,
+            0};
+
+        HGLRC context = createContextAttribs(native->hdc, NULL, attributes);
+        if (context == NULL)
+        {
+            wglMakeCurrent(NULL, NULL);
+            return false;
+        }
+
+        wglMakeCurrent(native->hdc, context);
+        wglDeleteContext(legacy);
+        native->context = context;
+    }
+
+    native->swapInterval = (PFNWGLSWAPINTERVALEXTPROC)wglGetProcAddress("wglSwapIntervalEXT");
+    auto getExtensions = (PFNWGLGETEXTENSIONSSTRINGEXTPROC)wglGetProcAddress("wglGetExtensionsStringEXT");
+    const char* extensions = getExtensions != nullptr ? getExtensions() : nullptr;
+    native->swapControlTear = extensions != nullptr && strstr(extensions, "WGL_EXT_swap_control_tear") != nullptr;
+    return true;
+}
+
+bool Surface::CreateImpl()
+{
+    native = new NativeSurface();
+    native->hWnd = (HWND)window->GetHandle();
+
+    if (desc.Api == SurfaceApi::OpenGL)
+    {
+        if (!CreateContext(native, desc))
+        {
+            DestroyImpl();
+            native = nullptr;
+            return false;
+        }
+
+        SetSwapIntervalImpl(swapInterval);
+    }
+
+    return true;
+}
+
+void Surface::DestroyImpl()
+{
+    if (native->context != NULL)
+    {
+        if (wglGetCurrentContext() == native->context)
+            wglMakeCurrent(NULL, NULL);
+        wglDeleteContext(native->context);
+    }
+
+    if (native->hdc != NULL)
+        ReleaseDC(native->hWnd, native->hdc);
+
+    delete native;
+}
+
+void Surface::ResizeImpl()
+{
+    // WGL 的默认帧缓冲跟随窗口大小，Vulkan 由使用者在回调中重建交换链
+}
+
+bool Surface::SetSwapIntervalImpl(int32_t interval)
+{
+    if (native->swapInterval == nullptr)
+        return false;
+
+    if (interval < 0 && !native->swapControlTear)
+        interval = 1;
+
+    return native->swapInterval(interval) != FALSE;
+}
+
+bool Surface::MakeCurrent()
+{
+    if (native == nullptr || native->context == NULL)
+        return false;
+
+    return wglMakeCurrent(native->hdc, native->context) != FALSE;
+}
+
+void Surface::SwapBuffers()
+{
+    if (native != nullptr && native->hdc != NULL)
+        ::SwapBuffers(native->hdc);
+}
+
+void* Surface::GetProcAddress(const char* name) const
+{
+    // wglGetProcAddress 不返回 OpenGL 1.1 的函数，这些函数从 opengl32.dll 导出
+    auto proc = (void*)wglGetProcAddress(name);
+    if (proc == nullptr || proc == (void*)1 || proc == (void*)2 || proc == (void*)3 || proc == (void*)-1)
+        proc = (void*)::GetProcAddress(GetModuleHandleW(L"opengl32.dll"), name);
+    return proc;
+}
+
+SurfaceHandles Surface::GetHandles() const
+{
+    SurfaceHandles handles;
+    if (native != nullptr)
+    {
+        handles.Instance = GetModuleHandle(NULL);
+        handles.Window = native->hWnd;
+    }
+    return handles;
+}
+#endif
@@ -0,0 +1,91 @@
+#include <cmath>
+#include "Surface.h"
+
+using namespace tk;
+
+Surface::Surface(Window* window)
+    : window(window)
+{
+}
+
+Surface::~Surface()
+{
+    Destroy();
+}
+
+bool Surface::Create(const SurfaceDesc& value)
+{
+    if (native != nullptr || window == nullptr || window->GetHandle() == nullptr)
+        return false;
+
+    desc = value;
+    swapInterval = desc.Mode == PresentMode::Fifo ? 1 : 0;
+    if (!CreateImpl())
+        return false;
+
+    // 关闭后原生窗口不再有效，先于窗口释放表面
+    listeners[0] = window->On<EventType::Resize>([this](Window*, Event&)
+                                                 { OnResize(); });
+    listeners[1] = window->On<EventType::DpiChanged>([this](Window*, Event&)
+                                                     { OnResize(); });
+    listeners[2] = window->On<EventType::Closed>([this](Window*, Event&)
+                                                 { Destroy(); });
+    return true;
+}
+
+void Surface::Destroy()
+{
+    if (native == nullptr)
+        return;
+
+    for (auto&& id : listeners)
+    {
+        window->RemoveEventListener(id);
+        id = 0;
+    }
+
+    DestroyImpl();
+    native = nullptr;
+}
+
+Size<int32_t> Surface::GetSize() const
+{
+    if (native == nullptr)
+        return {0, 0};
+
+    auto size = window->GetClientSize();
+    float scale = window->GetDpiScale();
+    return {(int32_t)std::lround(size.Width * scale), (int32_t)std::lround(size.Height * scale)};
+}
+
+bool Surface::SetPresentMode(PresentMode mode)
+{
+    desc.Mode = mode;
+    if (desc.Api != SurfaceApi::OpenGL)
+        return true;
+
+    return SetSwapInterval(mode == PresentMode::Fifo ? 1 : 0);
+}
+
+bool Surface::SetSwapInterval(int32_t interval)
+{
+    if (native == nullptr || desc.Api != SurfaceApi::OpenGL)
+        return false;
+
+    if (!SetSwapIntervalImpl(interval))
+        return false;
+
+    swapInterval = interval;
+    return true;
+}
+
+void Surface::OnResize()
+{
+    if (native == nullptr)
+        return;
+
+    ResizeImpl();
+
+    if (resizeCallback)
+        resizeCallback(this, GetSize());
+}
@@ -0,0 +1,155 @@
+#pragma once
+#include <functional>
+#include <stdint.h>
+#include "Window.h"
+
+namespace tk
+{
+struct NativeSurface;
+
+enum class SurfaceApi
+{
+    OpenGL,
+    Vulkan
+};
+
+// 与 VkPresentModeKHR 对应；OpenGL 中 Fifo 对应交换间隔 1，Mailbox 和 Immediate 对应 0，窗口模式下由合成器只显示最新的帧
+enum class PresentMode
+{
+    Fifo,
+    Mailbox,
+    Immediate
+};
+
+struct SurfaceDesc
+{
+    SurfaceApi Api = SurfaceApi::OpenGL;
+    PresentMode Mode = PresentMode::Fifo;
+
+    // 以下只用于 OpenGL，3.2 及以上创建 core profile
+    int32_t MajorVersion = 3;
+    int32_t MinorVersion = 2;
+    int32_t DepthBits = 24;
+    int32_t StencilBits = 8;
+};
+
+// 创建 Vulkan 表面需要的原生句柄：Windows 为 HINSTANCE 和 HWND，macOS 为 CAMetalLayer
+struct SurfaceHandles
+{
+    void* Instance = nullptr;
+    void* Window = nullptr;
+    void* Layer = nullptr;
+};
+
+// 为窗口创建 OpenGL 上下文或 Vulkan 需要的原生表面，窗口大小和 DPI 变化时自动调整，窗口关闭时自动销毁
+class Surface
+{
+public:
+    explicit Surface(Window* window);
+
+    ~Surface();
+
+    Surface(const Surface&) = delete;
+    Surface& operator=(const Surface&) = delete;
+
+    // 在窗口创建之后、所属线程中调用；OpenGL 上下文创建后在当前线程激活
+    bool Create(const SurfaceDesc& desc = SurfaceDesc{});
+
+    void Destroy();
+
+    bool IsCreated() const { return native != nullptr; }
+
+    Window* GetWindow() const { return window; }
+
+    const SurfaceDesc& GetDesc() const { return desc; }
+
+    // 客户区的像素大小
+    Size<int32_t> GetSize() const;
+
+    // 窗口大小或 DPI 变化、表面调整完成后调用，Vulkan 应在这里重建交换链；窗口关联 EventQueue 时在消费线程调用
+    void SetResizeCallback(std::function<void(Surface*, const Size<int32_t>&)> callback) { resizeCallback = std::move(callback); }
+
+    // OpenGL 中同时修改交换间隔，需要在上下文激活的线程调用；Vulkan 只记录，用 SelectPresentMode 选择交换链的模式
+    bool SetPresentMode(PresentMode mode);
+    PresentMode GetPresentMode() const { return desc.Mode; }
+
+    // 只用于 OpenGL，在上下文激活的线程调用；-1 表示自适应同步，不支持时按 1 处理
+    bool SetSwapInterval(int32_t interval);
+    int32_t GetSwapInterval() const { return swapInterval; }
+
+    // 只用于 OpenGL，可以在任意线程调用，同一时刻只能在一个线程激活
+    bool MakeCurrent();
+    void SwapBuffers();
+    void* GetProcAddress(const char* name) const;
+
+    // 只用于 Vulkan
+    SurfaceHandles GetHandles() const;
+
+private:
+    bool CreateImpl();
+    void DestroyImpl();
+    void ResizeImpl();
+    bool SetSwapIntervalImpl(int32_t interval);
+
+    void OnResize();
+
+    Window* window = nullptr;
+    NativeSurface* native = nullptr;
+    SurfaceDesc desc;
+    int32_t swapInterval = 1;
+    uint32_t listeners[3] = {};
+    std::function<void(Surface*, const Size<int32_t>&)> resizeCallback;
+};
+
+// 在包含 vulkan.h（以及对应平台的 VK_USE_PLATFORM_*）之后可用
+#if defined(VK_VERSION_1_0)
+// 按优先级选择设备支持的模式：Mailbox 退回 Fifo 以避免撕裂，Immediate 依次退回 Mailbox、Fifo；Fifo 总是支持
+inline VkPresentModeKHR SelectPresentMode(PresentMode mode, const VkPresentModeKHR* supported, uint32_t count)
+{
+    auto has = [&](VkPresentModeKHR m)
+    {
+        for (uint32_t i = 0; i < count; i++)
+        {
+            if (supported[i] == m)
+                return true;
+        }
+        return false;
+    };
+
+    if (mode == PresentMode::Immediate && has(VK_PRESENT_MODE_IMMEDIATE_KHR))
+        return VK_PRESENT_MODE_IMMEDIATE_KHR;
+    if (mode != PresentMode::Fifo && has(VK_PRESENT_MODE_MAILBOX_KHR))
+        return VK_PRESENT_MODE_MAILBOX_KHR;
+    return VK_PRESENT_MODE_FIFO_KHR;
+}
+#endif
+
+#if defined(VK_KHR_win32_surface)
+inline bool FillSurfaceCreateInfo(const Surface& surface, VkWin32SurfaceCreateInfoKHR& info)
+{
+    SurfaceHandles handles = surface.GetHandles();
+    if (handles.Window == nullptr)
+        return false;
+
+    info = {};
+    info.sType = VK_STRUCTURE_TYPE_WIN32_SURFACE_CREATE_INFO_KHR;
+    info.hinstance = (HINSTANCE)handles.Instance;
+    info.hwnd = (HWND)handles.Window;
+    return true;
+}
+#endif
+
+#if defined(VK_EXT_metal_surface)
+inline bool FillSurfaceCreateInfo(const Surface& surface, VkMetalSurfaceCreateInfoEXT& info)
+{
+    SurfaceHandles handles = surface.GetHandles();
+    if (handles.Layer == nullptr)
+        return false;
+
+    info = {};
+    info.sType = VK_STRUCTURE_TYPE_METAL_SURFACE_CREATE_INFO_EXT;
+    info.pLayer = (const CAMetalLayer*)handles.Layer;
+    return true;
+}
+#endif
+} // namespace tk
@@ -0,0 +1,183 @@
+#include <algorithm>
+#include "TaskPool.h"
+#include "Application.h"
+#include "Window.h"
+
+using namespace tk;
+
+static thread_local TaskPool* currentPool = nullptr;
+static thread_local size_t currentWorker = 0;
+
+TaskPool& TaskPool::Default()
+{
+    static TaskPool pool;
+    return pool;
+}
+
+TaskPool::TaskPool(size_t threads)
+{
+    if (threads == 0)
+        threads = (std::max)(std::thread::hardware_concurrency(), 1u);
+
+    workers.reserve(threads);
+    for (size_t i = 0; i < threads; i++)
+        workers.push_back(std::make_unique<Worker>());
+
+    // 所有队列就绪之后再启动线程，窃取时会访问其他线程的队列
+    for (size_t i = 0; i < threads; i++)
+        workers[i]->thread = std::thread([this, i]()
+                                         { Run(i); });
+}
+
+TaskPool::~TaskPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(sleepLock);
+        stopping = true;
+    }
+    sleepCond.notify_all();
+
+    for (auto&& worker : workers)
+        worker->thread.join();
+}
+
+void TaskPool::Post(std::function<void()> task)
+{
+    // 先计数再入队，计数只会暂时偏大，不会让取到任务的线程减到负数
+    pending.fetch_add(1);
+
+    if (currentPool == this)
+    {
+        auto& worker = *workers[currentWorker];
+        std::lock_guard<std::mutex> lock(worker.lock);
+        worker.tasks.push_back(std::move(task));
+    }
+    else
+    {
+        std::lock_guard<std::mutex> lock(sharedLock);
+        shared.push_back(std::move(task));
+    }
+
+    // 与等待方检查计数互斥，避免通知发生在检查之后、进入等待之前
+    {
+        std::lock_guard<std::mutex> lock(sleepLock);
+    }
+    sleepCond.notify_one();
+}
+
+// 依次取自己队列的尾部、外部提交的队列、其他线程队列的头部
+bool TaskPool::Take(size_t index, std::function<void()>& task)
+{
+    {
+        auto& own = *workers[index];
+        std::lock_guard<std::mutex> lock(own.lock);
+        if (!own.tasks.empty())
+        {
+            task = std::move(own.tasks.back());
+            own.tasks.pop_back();
+            return true;
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(sharedLock);
+        if (!shared.empty())
+        {
+            task = std::move(shared.front());
+            shared.pop_front();
+            return true;
+        }
+    }
+
+    for (size_t i = 1; i < workers.size(); i++)
+    {
+        auto& victim = *workers[(index + i) % workers.size()];
+        std::lock_guard<std::mutex> lock(victim.lock);
+        if (!victim.tasks.empty())
+        {
+            task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void TaskPool::Run(size_t index)
+{
+    currentPool = this;
+    currentWorker = index;
+
+    std::function<void()> task;
+    while (true)
+    {
+        if (Take(index, task))
+        {
+            pending.fetch_sub(1);
+            task();
+            task = nullptr;
+            continue;
+        }
+
+        // 退出前执行完所有已提交的任务
+        std::unique_lock<std::mutex> lock(sleepLock);
+        sleepCond.wait(lock, [this]()
+                       { return pending.load() > 0 || stopping; });
+        if (stopping && pending.load() == 0)
+            return;
+    }
+}
+
+BackgroundTaskCore::BackgroundTaskCore(Application* app, Window* window) : app(app), bound(window != nullptr)
+{
+    if (window != nullptr)
+        lifetime = window->GetLifetime();
+}
+
+bool BackgroundTaskCore::IsCancelled() const
+{
+    if (cancelled.load())
+        return true;
+
+    if (!bound)
+        return false;
+
+    auto alive = lifetime.lock();
+    return alive == nullptr || !alive->load();
+}
+
+// Complete 与 SetContinuation 中后发生的一方负责交付，保证只交付一次
+void BackgroundTaskCore::Complete()
+{
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        done = true;
+        if (continuation == nullptr)
+            return;
+    }
+    Deliver();
+}
+
+void BackgroundTaskCore::SetContinuation(std::function<void()> f)
+{
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        continuation = std::move(f);
+        if (!done)
+            return;
+    }
+    Deliver();
+}
+
+void BackgroundTaskCore::Deliver()
+{
+    if (IsCancelled())
+        return;
+
+    // 窗口可能在投递之后关闭，执行前在所属线程再检查一次；窗口只在该线程销毁，检查之后不会失效
+    app->InvokeAsync([self = shared_from_this()]()
+                     {
+        if (!self->IsCancelled())
+            self->continuation(); });
+}
@@ -0,0 +1,147 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace tk
+{
+class Application;
+class Window;
+
+// 工作窃取线程池：每个线程有自己的队列，空闲时从其他线程的队列头部窃取
+class TaskPool
+{
+public:
+    // 进程共用的线程池，线程数为 CPU 核数，第一次使用时创建
+    static TaskPool& Default();
+
+    // threads 为 0 时使用 std::thread::hardware_concurrency()
+    explicit TaskPool(size_t threads = 0);
+
+    TaskPool(const TaskPool&) = delete;
+    TaskPool& operator=(const TaskPool&) = delete;
+
+    // 等待已提交的任务全部执行完
+    ~TaskPool();
+
+    // 可以在任意线程调用；在池中的线程调用时放入该线程自己的队列，后进先出，否则放入共享队列
+    void Post(std::function<void()> task);
+
+    size_t GetThreadCount() const { return workers.size(); }
+
+private:
+    struct Worker
+    {
+        std::mutex lock;
+        std::deque<std::function<void()>> tasks;
+        std::thread thread;
+    };
+
+    void Run(size_t index);
+    bool Take(size_t index, std::function<void()>& task);
+
+    std::vector<std::unique_ptr<Worker>> workers;
+    std::mutex sharedLock;
+    std::deque<std::function<void()>> shared; // 池外线程提交的任务，先进先出
+    std::atomic<size_t> pending = 0;          // 已提交但尚未被取走的任务数
+    std::mutex sleepLock;
+    std::condition_variable sleepCond;
+    bool stopping = false;
+};
+
+// BackgroundTask 的共享状态中与结果类型无关的部分
+class BackgroundTaskCore : public std::enable_shared_from_this<BackgroundTaskCore>
+{
+public:
+    BackgroundTaskCore(Application* app, Window* window);
+
+    // 可以在任意线程调用；绑定的窗口关闭或销毁后视为已取消
+    bool IsCancelled() const;
+    void Cancel() { cancelled = true; }
+
+protected:
+    // 工作线程保存结果之后调用
+    void Complete();
+
+    // 只能在 app 所在线程调用
+    void SetContinuation(std::function<void()> f);
+
+private:
+    void Deliver();
+
+    Application* app;
+    std::weak_ptr<const std::atomic<bool>> lifetime;
+    bool bound;
+    std::atomic<bool> cancelled = false;
+    std::mutex lock;
+    bool done = false;
+    std::function<void()> continuation;
+};
+
+template <typename T>
+class BackgroundTaskState : public BackgroundTaskCore
+{
+public:
+    using BackgroundTaskCore::BackgroundTaskCore;
+
+    template <typename F>
+    void Run(F& task)
+    {
+        if (IsCancelled())
+            return;
+
+        if constexpr (std::is_void_v<T>)
+            task();
+        else
+            result.emplace(task());
+        Complete();
+    }
+
+    template <typename F>
+    void Then(F&& f)
+    {
+        // 状态由投递的任务持有，continuation 不必再持有自身
+        SetContinuation([this, f = std::forward<F>(f)]() mutable
+                        {
+            if constexpr (std::is_void_v<T>)
+                f();
+            else
+                f(std::move(*result)); });
+    }
+
+private:
+    std::optional<std::conditional_t<std::is_void_v<T>, bool, T>> result;
+};
+
+// Application::RunInBackground 的返回值，可以丢弃：没有 Then 时结果随状态一起释放
+template <typename T>
+class BackgroundTask
+{
+public:
+    explicit BackgroundTask(std::shared_ptr<BackgroundTaskState<T>> state) : state(std::move(state)) {}
+
+    // f 以任务的返回值为参数，在 RunInBackground 所在线程的任务队列中执行，任务已完成时也推迟到下一次循环
+    // 只能调用一次，只能在该线程调用；任务被取消时 f 不会执行
+    template <typename F>
+    BackgroundTask& Then(F&& f)
+    {
+        state->Then(std::forward<F>(f));
+        return *this;
+    }
+
+    // 可以在任意线程调用；尚未开始的任务不再执行，已经得到的结果不再交付
+    void Cancel() { state->Cancel(); }
+
+    bool IsCancelled() const { return state->IsCancelled(); }
+
+private:
+    std::shared_ptr<BackgroundTaskState<T>> state;
+};
+} // namespace tk
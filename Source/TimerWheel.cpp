@@ -0,0 +1,253 @@
+#include "TimerWheel.h"
+
+using namespace tk;
+
+static constexpr auto TICK = std::chrono::milliseconds(1);
+
+TimerWheel::TimerWheel()
+    : origin(Clock::now())
+{
+}
+
+TimerWheel::~TimerWheel()
+{
+    for (auto&& it : timers)
+        delete it.second;
+}
+
+uint64_t TimerWheel::ToTick(Clock::time_point t) const
+{
+    if (t <= origin)
+        return 0;
+
+    return (uint64_t)((t - origin) / TICK);
+}
+
+TimerWheel::Clock::time_point TimerWheel::FromTick(uint64_t tick) const
+{
+    return origin + std::chrono::duration_cast<Clock::duration>(TICK) * (int64_t)tick;
+}
+
+TimerWheel::Link& TimerWheel::GetSlot(int32_t level, uint64_t tick)
+{
+    if (level == 0)
+        return root[tick & (ROOT_SIZE - 1)];
+
+    return levels[level - 1][(tick >> Shift(level)) & (LEVEL_SIZE - 1)];
+}
+
+const TimerWheel::Link& TimerWheel::GetSlot(int32_t level, uint64_t tick) const
+{
+    return const_cast<TimerWheel*>(this)->GetSlot(level, tick);
+}
+
+void TimerWheel::Place(Timer* timer)
+{
+    if (timer->expires < current)
+        timer->expires = current;
+
+    uint64_t delta = timer->expires - current;
+    uint64_t tick = delta < MAX_DELTA ? timer->expires : current + MAX_DELTA - 1;
+
+    int32_t level = 0;
+    while (level < LEVELS - 1 && (tick - current) >= (1ull << Shift(level + 1)))
+        level++;
+
+    Link& slot = GetSlot(level, tick);
+    timer->level = level;
+    timer->prev = slot.prev;
+    timer->next = &slot;
+    slot.prev->next = timer;
+    slot.prev = timer;
+    counts[level]++;
+}
+
+void TimerWheel::Unlink(Timer* timer)
+{
+    timer->prev->next = timer->next;
+    timer->next->prev = timer->prev;
+    timer->prev = timer->next = timer;
+    counts[timer->level]--;
+}
+
+void TimerWheel::Cascade(int32_t level)
+{
+    Link& slot = GetSlot(level, current);
+    while (!slot.Empty())
+    {
+        auto timer = static_cast<Timer*>(slot.next);
+        Unlink(timer);
+        Place(timer);
+    }
+}
+
+uint32_t TimerWheel::Add(Clock::time_point deadline, Clock::duration interval, const std::function<void()>& callback)
+{
+    auto timer = new Timer();
+    timer->id = ++nextId;
+    timer->deadline = deadline;
+    timer->interval = interval;
+    timer->expires = ToTick(deadline);
+    timer->callback = callback;
+    timers.emplace(timer->id, timer);
+    Place(timer);
+    return timer->id;
+}
+
+bool TimerWheel::Cancel(uint32_t id)
+{
+    auto it = timers.find(id);
+    if (it == timers.end())
+        return false;
+
+    auto timer = it->second;
+    timers.erase(it);
+    Unlink(timer);
+    delete timer;
+    return true;
+}
+
+void TimerWheel::Fire(Timer* timer, Clock::time_point now)
+{
+    auto id = timer->id;
+    auto callback = std::move(timer->callback);
+
+    if (timer->interval <= Clock::duration::zero())
+    {
+        timers.erase(id);
+        delete timer;
+        callback();
+        return;
+    }
+
+    // 周期定时器先重新入轮再回调，这样回调里可以取消自己
+    timer->deadline = AddSaturated(timer->deadline, timer->interval);
+    if (timer->deadline <= now)
+        timer->deadline = AddSaturated(now, timer->interval);
+    timer->expires = ToTick(timer->deadline);
+    Place(timer);
+
+    callback();
+
+    auto it = timers.find(id);
+    if (it != timers.end())
+        it->second->callback = std::move(callback);
+}
+
+void TimerWheel::Advance(Clock::time_point now)
+{
+    uint64_t now_tick = ToTick(now);
+
+    while (!timers.empty())
+    {
+        // 第 0 层为空时直接跳到最低非空层的下一个级联边界
+        if (counts[0] == 0 && current < now_tick)
+        {
+            int32_t level = 1;
+            while (level < LEVELS && counts[level] == 0)
+                level++;
+
+            if (level == LEVELS)
+                break;
+
+            uint64_t granularity = 1ull << Shift(level);
+            uint64_t boundary = (current + granularity - 1) & ~(granularity - 1);
+            current = boundary < now_tick ? boundary : now_tick;
+        }
+
+        if ((current & (ROOT_SIZE - 1)) == 0 && cascaded != current)
+        {
+            cascaded = current;
+            for (int32_t level = 1; level < LEVELS; level++)
+            {
+                Cascade(level);
+                if (((current >> Shift(level)) & (LEVEL_SIZE - 1)) != 0)
+                    break;
+            }
+        }
+
+        Link pending;
+        Link& slot = GetSlot(0, current);
+        if (!slot.Empty())
+        {
+            pending.next = slot.next;
+            pending.prev = slot.prev;
+            pending.next->prev = &pending;
+            pending.prev->next = &pending;
+            slot.prev = slot.next = &slot;
+        }
+
+        bool partial = current >= now_tick;
+        if (!partial)
+            current++;
+
+        while (!pending.Empty())
+        {
+            auto timer = static_cast<Timer*>(pending.next);
+            Unlink(timer);
+
+            // 当前 tick 只处理到 now 为止，未到期的放回原槽位；超过 MAX_DELTA 被截断到较早槽位的定时器重新放置
+            if (timer->deadline > now)
+            {
+                Place(timer);
+                continue;
+            }
+
+            Fire(timer, now);
+        }
+
+        if (partial)
+            break;
+    }
+
+    if (current < now_tick)
+        current = now_tick;
+}
+
+TimerWheel::Clock::time_point TimerWheel::NextDeadline() const
+{
+    if (timers.empty())
+        return Clock::time_point::max();
+
+    // 下一个级联边界之前的槽位里都是精确的 deadline
+    uint64_t boundary = (current | (ROOT_SIZE - 1)) + 1;
+    for (uint64_t tick = current; tick < boundary && counts[0] > 0; tick++)
+    {
+        const Link& slot = GetSlot(0, tick);
+        if (slot.Empty())
+            continue;
+
+        auto deadline = Clock::time_point::max();
+        for (auto link = slot.next; link != &slot; link = link->next)
+        {
+            auto timer = static_cast<const Timer*>(link);
+            if (timer->deadline < deadline)
+                deadline = timer->deadline;
+        }
+        return deadline;
+    }
+
+    // 其余的定时器只能给出级联边界作为下界，到时 Advance 会把它们移到更低的层
+    uint64_t next = counts[0] > 0 ? boundary : UINT64_MAX;
+    for (int32_t level = 1; level < LEVELS; level++)
+    {
+        if (counts[level] == 0)
+            continue;
+
+        int32_t shift = Shift(level);
+        for (uint64_t k = 1; k <= LEVEL_SIZE; k++)
+        {
+            uint64_t tick = ((current >> shift) + k) << shift;
+            if (tick >= next)
+                break;
+
+            if (!GetSlot(level, tick).Empty())
+            {
+                next = tick;
+                break;
+            }
+        }
+    }
+
+    return FromTick(next);
+}
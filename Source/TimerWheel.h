@@ -0,0 +1,89 @@
+#pragma once
+#include <chrono>
+#include <functional>
+#include <unordered_map>
+#include <stdint.h>
+
+namespace tk
+{
+// 分层时间轮：第 0 层 256 个 1ms 槽，之上 4 层各 64 个槽，覆盖约 49 天
+// 同一个 tick 内按精确的 deadline 触发，所以精度不受槽宽限制
+class TimerWheel
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    TimerWheel();
+
+    ~TimerWheel();
+
+    TimerWheel(const TimerWheel&) = delete;
+    TimerWheel& operator=(const TimerWheel&) = delete;
+
+    // t + d，溢出时返回 time_point::max()；d 不能为负
+    static Clock::time_point AddSaturated(Clock::time_point t, Clock::duration d)
+    {
+        return d >= Clock::time_point::max() - t ? Clock::time_point::max() : t + d;
+    }
+
+    uint32_t Add(Clock::time_point deadline, Clock::duration interval, const std::function<void()>& callback);
+
+    bool Cancel(uint32_t id);
+
+    // 触发所有 deadline <= now 的定时器，回调中可以再添加或取消定时器
+    void Advance(Clock::time_point now);
+
+    // 下一次需要调用 Advance 的时间点，没有定时器时返回 time_point::max()
+    Clock::time_point NextDeadline() const;
+
+    size_t Size() const { return timers.size(); }
+
+private:
+    struct Link
+    {
+        Link* prev = this;
+        Link* next = this;
+
+        bool Empty() const { return next == this; }
+    };
+
+    struct Timer : public Link
+    {
+        uint32_t id;
+        int32_t level;
+        uint64_t expires;
+        Clock::time_point deadline;
+        Clock::duration interval;
+        std::function<void()> callback;
+    };
+
+    static constexpr int32_t LEVELS = 5;
+    static constexpr int32_t ROOT_BITS = 8;
+    static constexpr int32_t LEVEL_BITS = 6;
+    static constexpr uint64_t ROOT_SIZE = 1ull << ROOT_BITS;
+    static constexpr uint64_t LEVEL_SIZE = 1ull << LEVEL_BITS;
+    static constexpr uint64_t MAX_DELTA = 1ull << (ROOT_BITS + LEVEL_BITS * (LEVELS - 1));
+
+    static int32_t Shift(int32_t level) { return level == 0 ? 0 : ROOT_BITS + LEVEL_BITS * (level - 1); }
+
+    uint64_t ToTick(Clock::time_point t) const;
+    Clock::time_point FromTick(uint64_t tick) const;
+
+    Link& GetSlot(int32_t level, uint64_t tick);
+    const Link& GetSlot(int32_t level, uint64_t tick) const;
+
+    void Place(Timer* timer);
+    void Unlink(Timer* timer);
+    void Cascade(int32_t level);
+    void Fire(Timer* timer, Clock::time_point now);
+
+    Clock::time_point origin;
+    uint64_t current = 0;
+    uint64_t cascaded = UINT64_MAX;
+    uint32_t nextId = 0;
+    size_t counts[LEVELS] = {};
+    Link root[ROOT_SIZE];
+    Link levels[LEVELS - 1][LEVEL_SIZE];
+    std::unordered_map<uint32_t, Timer*> timers;
+};
+} // namespace tk
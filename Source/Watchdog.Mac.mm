@@ -0,0 +1,114 @@
+#if defined(__APPLE__)
+#include "TargetConditionals.h"
+#if defined(TARGET_OS_MAC)
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <errno.h>
+#include <execinfo.h>
+#include <mutex>
+#include <pthread.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+// 默认被忽略、很少被使用的信号，用来让被监视的线程在信号处理函数中回溯自己的栈
+constexpr int WATCHDOG_SIGNAL = SIGURG;
+// 信号处理函数本身和 _sigtramp
+constexpr int WATCHDOG_SKIP_FRAMES = 2;
+
+struct SampleRequest
+{
+    void** frames;
+    int maxFrames;
+    int count;
+    std::atomic<bool> done;
+};
+
+// 同一时间只有一个采样请求，由信号处理函数取走
+static std::mutex sampleLock;
+static std::atomic<SampleRequest*> sampleRequest = nullptr;
+static std::once_flag handlerOnce;
+
+static void SampleHandler(int signal, siginfo_t* info, void* context)
+{
+    auto request = sampleRequest.exchange(nullptr);
+    if (request == nullptr)
+        return;
+
+    int saved = errno;
+    request->count = backtrace(request->frames, request->maxFrames);
+    request->done.store(true, std::memory_order_release);
+    errno = saved;
+}
+
+uintptr_t WatchdogOpenThread()
+{
+    std::call_once(handlerOnce, []()
+                   {
+        struct sigaction action = {};
+        action.sa_sigaction = SampleHandler;
+        action.sa_flags = SA_SIGINFO | SA_RESTART;
+        sigemptyset(&action.sa_mask);
+        sigaction(WATCHDOG_SIGNAL, &action, nullptr); });
+
+    // 第一次调用 backtrace 可能加载符号信息，不能留到信号处理函数中
+    void* frame;
+    backtrace(&frame, 1);
+    return (uintptr_t)pthread_self();
+}
+
+void WatchdogCloseThread(uintptr_t thread)
+{
+}
+
+size_t WatchdogCaptureStack(uintptr_t thread, uintptr_t* frames, size_t maxFrames)
+{
+    void* buffer[128];
+    SampleRequest request;
+    request.frames = buffer;
+    request.maxFrames = (int)(std::min)(maxFrames + WATCHDOG_SKIP_FRAMES, sizeof(buffer) / sizeof(buffer[0]));
+    request.count = 0;
+    request.done = false;
+
+    std::lock_guard<std::mutex> lock(sampleLock);
+    sampleRequest = &request;
+    if (pthread_kill((pthread_t)thread, WATCHDOG_SIGNAL) != 0)
+    {
+        sampleRequest = nullptr;
+        return 0;
+    }
+
+    // 信号被屏蔽或线程在不可中断的系统调用中时放弃；已经被取走的请求一定会很快完成
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(200);
+    while (!request.done.load(std::memory_order_acquire))
+    {
+        if (std::chrono::steady_clock::now() > deadline && sampleRequest.exchange(nullptr) != nullptr)
+            return 0;
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    size_t count = 0;
+    for (int i = WATCHDOG_SKIP_FRAMES; i < request.count && count < maxFrames; i++)
+        frames[count++] = (uintptr_t)buffer[i];
+    return count;
+}
+
+void WatchdogSymbolize(const uintptr_t* frames, size_t count, std::vector<std::string>& stack)
+{
+    if (count == 0)
+        return;
+
+    char** symbols = backtrace_symbols((void* const*)frames, (int)count);
+    if (symbols == nullptr)
+        return;
+
+    for (size_t i = 0; i < count; i++)
+        stack.push_back(symbols[i]);
+    free(symbols);
+}
+#endif
+#endif
@@ -0,0 +1,148 @@
+#ifdef _WIN32
+#include <Windows.h>
+#include <DbgHelp.h>
+#include <mutex>
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+// DbgHelp 的函数都不是线程安全的，多个 Application 的监视线程共用这把锁
+static std::mutex symbolLock;
+static bool symbolsReady = false;
+
+static void InitSymbols()
+{
+    if (symbolsReady)
+        return;
+
+    SymSetOptions(SymGetOptions() | SYMOPT_DEFERRED_LOADS | SYMOPT_LOAD_LINES | SYMOPT_UNDNAME);
+    symbolsReady = SymInitialize(GetCurrentProcess(), NULL, TRUE) != FALSE;
+}
+
+uintptr_t WatchdogOpenThread()
+{
+    HANDLE thread = NULL;
+    if (!DuplicateHandle(GetCurrentProcess(), GetCurrentThread(), GetCurrentProcess(), &thread,
+                         THREAD_SUSPEND_RESUME | THREAD_GET_CONTEXT | THREAD_QUERY_INFORMATION, FALSE, 0))
+        return 0;
+
+    // 提前加载符号，报告时不必在停顿中等待
+    std::lock_guard<std::mutex> lock(symbolLock);
+    InitSymbols();
+    return (uintptr_t)thread;
+}
+
+void WatchdogCloseThread(uintptr_t thread)
+{
+    CloseHandle((HANDLE)thread);
+}
+
+// 目标线程挂起期间可能持有堆锁，这里只能写入 frames，不能分配内存
+size_t WatchdogCaptureStack(uintptr_t thread, uintptr_t* frames, size_t maxFrames)
+{
+    HANDLE handle = (HANDLE)thread;
+    if (SuspendThread(handle) == (DWORD)-1)
+        return 0;
+
+    size_t count = 0;
+    CONTEXT context;
+    ZeroMemory(&context, sizeof(context));
+    context.ContextFlags = CONTEXT_FULL;
+
+    // GetThreadContext 会等到挂起真正生效
+    if (GetThreadContext(handle, &context))
+    {
+#if defined(_M_X64) || defined(_M_ARM64)
+        // 按 unwind 表回溯，不经过 DbgHelp，不会分配内存
+#if defined(_M_X64)
+        DWORD64& pc = context.Rip;
+#else
+        DWORD64& pc = context.Pc;
+#endif
+        while (count < maxFrames && pc != 0)
+        {
+            frames[count++] = (uintptr_t)pc;
+
+            DWORD64 imageBase;
+            auto function = RtlLookupFunctionEntry(pc, &imageBase, NULL);
+            if (function == NULL)
+            {
+                // 叶函数没有 unwind 信息，返回地址就在栈顶（ARM64 在 LR 中）
+#if defined(_M_X64)
+                context.Rip = *(DWORD64*)context.Rsp;
+                context.Rsp += 8;
+#else
+                if (context.Lr == pc)
+                    break;
+                context.Pc = context.Lr;
+#endif
+                continue;
+            }
+
+            PVOID handlerData;
+            DWORD64 establisherFrame;
+            RtlVirtualUnwind(UNW_FLAG_NHANDLER, imageBase, pc, function, &context, &handlerData, &establisherFrame, NULL);
+        }
+#else
+        // x86 没有 unwind 表，只能交给 StackWalk64 按帧指针和 FPO 信息回溯
+        STACKFRAME64 frame;
+        ZeroMemory(&frame, sizeof(frame));
+        frame.AddrPC.Offset = context.Eip;
+        frame.AddrPC.Mode = AddrModeFlat;
+        frame.AddrFrame.Offset = context.Ebp;
+        frame.AddrFrame.Mode = AddrModeFlat;
+        frame.AddrStack.Offset = context.Esp;
+        frame.AddrStack.Mode = AddrModeFlat;
+
+        std::lock_guard<std::mutex> lock(symbolLock);
+        while (count < maxFrames && StackWalk64(IMAGE_FILE_MACHINE_I386, GetCurrentProcess(), handle, &frame, &context,
+                                                NULL, SymFunctionTableAccess64, SymGetModuleBase64, NULL))
+        {
+            if (frame.AddrPC.Offset == 0)
+                break;
+            frames[count++] = (uintptr_t)frame.AddrPC.Offset;
+        }
+#endif
+    }
+
+    ResumeThread(handle);
+    return count;
+}
+
+void WatchdogSymbolize(const uintptr_t* frames, size_t count, std::vector<std::string>& stack)
+{
+    std::lock_guard<std::mutex> lock(symbolLock);
+    InitSymbols();
+
+    alignas(SYMBOL_INFO) char buffer[sizeof(SYMBOL_INFO) + MAX_SYM_NAME];
+    auto symbol = (SYMBOL_INFO*)buffer;
+
+    for (size_t i = 0; i < count; i++)
+    {
+        char text[MAX_SYM_NAME + MAX_PATH + 64];
+        DWORD64 address = frames[i];
+
+        ZeroMemory(buffer, sizeof(buffer));
+        symbol->SizeOfStruct = sizeof(SYMBOL_INFO);
+        symbol->MaxNameLen = MAX_SYM_NAME;
+
+        DWORD64 offset = 0;
+        if (symbolsReady && SymFromAddr(GetCurrentProcess(), address, &offset, symbol))
+        {
+            IMAGEHLP_LINE64 line;
+            ZeroMemory(&line, sizeof(line));
+            line.SizeOfStruct = sizeof(line);
+            DWORD column = 0;
+            if (SymGetLineFromAddr64(GetCurrentProcess(), address, &column, &line))
+                snprintf(text, sizeof(text), "%s+0x%llx (%s:%lu)", symbol->Name, (unsigned long long)offset, line.FileName, line.LineNumber);
+            else
+                snprintf(text, sizeof(text), "%s+0x%llx", symbol->Name, (unsigned long long)offset);
+        }
+        else
+        {
+            snprintf(text, sizeof(text), "0x%llx", (unsigned long long)address);
+        }
+        stack.push_back(text);
+    }
+}
+#endif
@@ -0,0 +1,93 @@
+#include <algorithm>
+#include "Watchdog.h"
+
+using namespace tk;
+
+constexpr size_t WATCHDOG_MAX_FRAMES = 64;
+
+extern size_t WatchdogCaptureStack(uintptr_t thread, uintptr_t* frames, size_t maxFrames);
+extern void WatchdogSymbolize(const uintptr_t* frames, size_t count, std::vector<std::string>& stack);
+extern void WatchdogCloseThread(uintptr_t thread);
+
+namespace tk
+{
+thread_local WatchdogActivity* watchdogActivity = nullptr;
+}
+
+// 由后端在系统的模态循环（调整窗口大小、菜单）前后调用，期间不检测停顿
+void PauseWatchdog(bool paused)
+{
+    if (watchdogActivity != nullptr)
+        watchdogActivity->paused.store(paused, std::memory_order_relaxed);
+}
+
+Watchdog::Watchdog(WatchdogActivity& activity, const std::atomic<bool>& waiting, uintptr_t thread,
+                   std::chrono::steady_clock::duration threshold, const std::function<void(const StallReport&)>& callback)
+    : activity(activity), waiting(waiting), thread(thread), threshold(threshold), callback(callback)
+{
+    worker = std::thread([this]()
+                         { Run(); });
+}
+
+Watchdog::~Watchdog()
+{
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        stopping = true;
+    }
+    cond.notify_one();
+    worker.join();
+
+    WatchdogCloseThread(thread);
+}
+
+void Watchdog::Run()
+{
+    using Clock = std::chrono::steady_clock;
+
+    // 检查间隔远小于阈值，报告的停顿时间最多比实际短一个间隔
+    auto interval = (std::max)(threshold / 8, Clock::duration(std::chrono::milliseconds(5)));
+    auto last = activity.heartbeat.load(std::memory_order_relaxed);
+    auto since = Clock::now();
+    bool reported = false;
+
+    std::unique_lock<std::mutex> guard(lock);
+    while (!cond.wait_for(guard, interval, [this]()
+                          { return stopping; }))
+    {
+        auto beat = activity.heartbeat.load(std::memory_order_relaxed);
+        auto now = Clock::now();
+        bool idle = (beat & 1) != 0 || waiting.load(std::memory_order_relaxed) || activity.paused.load(std::memory_order_relaxed);
+        if (beat != last || idle)
+        {
+            last = beat;
+            since = now;
+            reported = false;
+            continue;
+        }
+
+        // 同一次停顿只报告一次，循环恢复后重新计时
+        if (reported || now - since < threshold)
+            continue;
+
+        reported = true;
+        guard.unlock();
+        Report(now - since);
+        guard.lock();
+    }
+}
+
+void Watchdog::Report(std::chrono::steady_clock::duration duration)
+{
+    StallReport report;
+    report.Duration = duration;
+    report.ActiveWindow = activity.window.load(std::memory_order_relaxed);
+    report.ActiveEvent = activity.event.load(std::memory_order_relaxed);
+
+    // 采集期间被监视线程可能被挂起，不能在这里分配内存；符号化在它恢复之后进行
+    uintptr_t frames[WATCHDOG_MAX_FRAMES];
+    size_t count = WatchdogCaptureStack(thread, frames, WATCHDOG_MAX_FRAMES);
+    WatchdogSymbolize(frames, count, report.Stack);
+
+    callback(report);
+}
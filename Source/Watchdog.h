@@ -0,0 +1,85 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include "Application.h"
+
+namespace tk
+{
+// 被监视线程写入、监视线程只读的状态
+struct WatchdogActivity
+{
+    std::atomic<uint64_t> heartbeat = 0; // 每次循环递增 2，奇数表示在外部循环中空闲
+    std::atomic<Window*> window = nullptr;
+    std::atomic<EventType> event = EventType::None;
+    std::atomic<bool> paused = false; // 在系统的模态循环中，循环被合法地阻塞
+};
+
+// 开启监视时指向本线程的 WatchdogActivity，否则为 nullptr
+extern thread_local WatchdogActivity* watchdogActivity;
+
+// 记录正在处理的窗口和事件，退出时恢复外层的值；没有开启监视时只读取一次线程局部变量
+class WatchdogScope
+{
+public:
+    WatchdogScope(Window* win, EventType type) : activity(watchdogActivity)
+    {
+        if (activity == nullptr)
+            return;
+
+        window = activity->window.load(std::memory_order_relaxed);
+        event = activity->event.load(std::memory_order_relaxed);
+        activity->window.store(win, std::memory_order_relaxed);
+        activity->event.store(type, std::memory_order_relaxed);
+    }
+
+    WatchdogScope(const WatchdogScope&) = delete;
+    WatchdogScope& operator=(const WatchdogScope&) = delete;
+
+    ~WatchdogScope()
+    {
+        if (activity == nullptr)
+            return;
+
+        activity->window.store(window, std::memory_order_relaxed);
+        activity->event.store(event, std::memory_order_relaxed);
+    }
+
+private:
+    WatchdogActivity* activity;
+    Window* window = nullptr;
+    EventType event = EventType::None;
+};
+
+// 在构造它的线程上监视 activity 的心跳，停顿超过 threshold 时采集该线程的调用栈并调用 callback
+class Watchdog
+{
+public:
+    Watchdog(WatchdogActivity& activity, const std::atomic<bool>& waiting, uintptr_t thread,
+             std::chrono::steady_clock::duration threshold, const std::function<void(const StallReport&)>& callback);
+
+    Watchdog(const Watchdog&) = delete;
+    Watchdog& operator=(const Watchdog&) = delete;
+
+    // 等待正在执行的 callback 返回，之后关闭 thread
+    ~Watchdog();
+
+private:
+    void Run();
+    void Report(std::chrono::steady_clock::duration duration);
+
+    WatchdogActivity& activity;
+    const std::atomic<bool>& waiting;
+    uintptr_t thread;
+    std::chrono::steady_clock::duration threshold;
+    std::function<void(const StallReport&)> callback;
+
+    std::mutex lock;
+    std::condition_variable cond;
+    bool stopping = false;
+    std::thread worker;
+};
+} // namespace tk
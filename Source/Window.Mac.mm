@@ -3,8 +3,10 @@
 #if defined(TARGET_OS_MAC)
 
 #import <Cocoa/Cocoa.h>
+#include <algorithm>
 #include "Application.h"
 #include "Window.h"
+#include "EventQueue.h"
 
 using namespace tk;
 
@@ -18,8 +20,17 @@ struct NativeWindow
     NSWindow* window;
     NSObject* delegate;
 
+    // 独占全屏前的样式、位置和层级，退出时还原
+    CGDirectDisplayID display = 0;
+    NSWindowStyleMask savedStyle = 0;
+    NSRect savedFrame = NSZeroRect;
+    NSInteger savedLevel = NSNormalWindowLevel;
+
     ~NativeWindow()
     {
+        if (display != 0)
+            CGDisplayRelease(display);
+
         if (window)
         {
             [window close];
@@ -30,10 +41,35 @@ struct NativeWindow
 };
 } // namespace tk
 
-bool DispatchEvent(NSWindow* nswin, NSEvent* event);
+// 无标题栏的窗口默认不能成为 key window，独占全屏时仍需要接收键盘输入
+@interface NativeNSWindow : NSWindow
+@end
 
-@interface NativeView : NSView
+@implementation NativeNSWindow
+- (BOOL)canBecomeKeyWindow
+{
+    return YES;
+}
+- (BOOL)canBecomeMainWindow
+{
+    return YES;
+}
+@end
 
+bool DispatchEvent(NSWindow* nswin, NSEvent* event);
+void EnsureBackend();
+void RecordFirstWindow();
+void AppWakeUp(uintptr_t thread);
+void PauseWatchdog(bool paused);
+NativeWindow* AcquirePooledWindow(int32_t style);
+bool IsCreatingWindows();
+void ReleasePooledWindow(NativeWindow* native, int32_t style);
+Window* WindowFromNSWindow(NSWindow* nswin);
+
+@interface NativeView : NSView <NSTextInputClient>
+{
+    NSMutableAttributedString* markedText;
+}
 @end
 
 @implementation NativeView
@@ -65,6 +101,9 @@ bool DispatchEvent(NSWindow* nswin, NSEvent* event);
 - (void)keyDown:(NSEvent*)event
 {
     DispatchEvent([self window], event);
+
+    // 文本和输入法组合通过 NSTextInputClient 回调进入
+    [self interpretKeyEvents:@[ event ]];
 }
 - (void)flagsChanged:(NSEvent*)event
 {
@@ -125,6 +164,91 @@ bool DispatchEvent(NSWindow* nswin, NSEvent* event);
 {
     DispatchEvent([self window], event);
 }
+
+- (void)dispatchComposition:(NSString*)text cursor:(NSUInteger)cursor
+{
+    Window* window = WindowFromNSWindow([self window]);
+    if (window == nullptr)
+        return;
+
+    FlushTextInput(window);
+
+    const char* utf8 = [text UTF8String];
+    TextCompositionEvent e;
+    e.type = EventType::TextComposition;
+    e.Text = utf8 != nullptr ? std::string_view(utf8) : std::string_view();
+    e.Cursor = (int32_t)[[text substringToIndex:std::min(cursor, (NSUInteger)[text length])] lengthOfBytesUsingEncoding:NSUTF8StringEncoding];
+    DispatchEvent(window, &e);
+}
+
+- (void)insertText:(id)string replacementRange:(NSRange)replacementRange
+{
+    NSString* text = [string isKindOfClass:[NSAttributedString class]] ? [string string] : string;
+
+    if ([self hasMarkedText])
+        [self unmarkText];
+
+    Window* window = WindowFromNSWindow([self window]);
+    const char* utf8 = [text UTF8String];
+    if (window != nullptr && utf8 != nullptr)
+        AppendTextInput(window, utf8);
+}
+
+- (void)doCommandBySelector:(SEL)selector
+{
+}
+
+- (void)setMarkedText:(id)string selectedRange:(NSRange)selectedRange replacementRange:(NSRange)replacementRange
+{
+    NSString* text = [string isKindOfClass:[NSAttributedString class]] ? [string string] : string;
+    markedText = [[NSMutableAttributedString alloc] initWithString:text];
+
+    [self dispatchComposition:text cursor:selectedRange.location];
+}
+
+- (void)unmarkText
+{
+    markedText = nil;
+    [self dispatchComposition:@"" cursor:0];
+}
+
+- (BOOL)hasMarkedText
+{
+    return markedText != nil && [markedText length] > 0;
+}
+
+- (NSRange)markedRange
+{
+    if ([self hasMarkedText])
+        return NSMakeRange(0, [markedText length]);
+    return NSMakeRange(NSNotFound, 0);
+}
+
+- (NSRange)selectedRange
+{
+    return NSMakeRange(NSNotFound, 0);
+}
+
+- (NSArray<NSAttributedStringKey>*)validAttributesForMarkedText
+{
+    return @[];
+}
+
+- (NSAttributedString*)attributedSubstringForProposedRange:(NSRange)range actualRange:(NSRangePointer)actualRange
+{
+    return nil;
+}
+
+- (NSUInteger)characterIndexForPoint:(NSPoint)point
+{
+    return 0;
+}
+
+- (NSRect)firstRectForCharacterRange:(NSRange)range actualRange:(NSRangePointer)actualRange
+{
+    NSRect frame = [self convertRect:[self bounds] toView:nil];
+    return [[self window] convertRectToScreen:NSMakeRect(frame.origin.x, frame.origin.y, 0, 0)];
+}
 @end
 
 // 使用NSWindowDelegate来处理左上角关闭按钮的逻辑
@@ -134,6 +258,15 @@ bool DispatchEvent(NSWindow* nswin, NSEvent* event);
 - (void)windowWillClose:(NSNotification*)notification;
 - (void)windowDidResize:(NSWindow*)sender;
 - (void)windowDidChangeBackingProperties:(NSNotification*)notification;
+- (void)windowDidChangeOcclusionState:(NSNotification*)notification;
+- (void)windowDidBecomeKey:(NSNotification*)notification;
+- (void)windowDidResignKey:(NSNotification*)notification;
+- (void)windowDidMiniaturize:(NSNotification*)notification;
+- (void)windowDidDeminiaturize:(NSNotification*)notification;
+- (void)windowDidEnterFullScreen:(NSNotification*)notification;
+- (void)windowDidExitFullScreen:(NSNotification*)notification;
+- (void)windowWillStartLiveResize:(NSNotification*)notification;
+- (void)windowDidEndLiveResize:(NSNotification*)notification;
 - (void)setWindow:(Window*)win;
 - (Window*)getWindow;
 @property(nonatomic) Window* window;
@@ -153,14 +286,24 @@ bool DispatchEvent(NSWindow* nswin, NSEvent* event);
 
 - (BOOL)windowShouldClose:(NSWindow*)sender
 {
+    // 池中的窗口没有关联的 Window
+    if (_window == nullptr)
+        return YES;
+
     Event e;
     e.type = EventType::Closing;
     DispatchEvent(_window, &e);
-    return e.result == 0;
+    if (e.result != 0)
+        return NO;
+
+    return !(_window->HasStyle(WINDOW_POOLED) && RecycleWindow(_window));
 }
 
 - (void)windowWillClose:(NSNotification*)notification
 {
+    if (_window == nullptr)
+        return;
+
     Event e;
     e.type = EventType::Closed;
     DispatchEvent(_window, &e);
@@ -168,16 +311,67 @@ bool DispatchEvent(NSWindow* nswin, NSEvent* event);
 
 - (void)windowDidResize:(NSWindow*)sender
 {
+    if (_window == nullptr)
+        return;
+
     Event e;
     e.type = EventType::Resize;
     DispatchEvent(_window, &e);
+    NotifyWindowState(_window);
 }
 - (void)windowDidChangeBackingProperties:(NSNotification*)notification
 {
+    if (_window == nullptr)
+        return;
+
     Event e;
     e.type = EventType::DpiChanged;
     DispatchEvent(_window, &e);
 }
+- (void)windowDidChangeOcclusionState:(NSNotification*)notification
+{
+    // 遮挡状态变化不产生事件，唤醒消息循环重新计算暂停窗口的更新间隔
+    AppWakeUp(0);
+}
+- (void)windowDidBecomeKey:(NSNotification*)notification
+{
+    if (_window != nullptr)
+        PublishWindowSnapshot(_window);
+}
+- (void)windowDidResignKey:(NSNotification*)notification
+{
+    if (_window != nullptr)
+        PublishWindowSnapshot(_window);
+}
+- (void)windowDidMiniaturize:(NSNotification*)notification
+{
+    if (_window != nullptr)
+        NotifyWindowState(_window);
+}
+- (void)windowDidDeminiaturize:(NSNotification*)notification
+{
+    if (_window != nullptr)
+        NotifyWindowState(_window);
+}
+- (void)windowDidEnterFullScreen:(NSNotification*)notification
+{
+    if (_window != nullptr)
+        NotifyWindowState(_window);
+}
+- (void)windowDidExitFullScreen:(NSNotification*)notification
+{
+    if (_window != nullptr)
+        NotifyWindowState(_window);
+}
+// 拖动调整大小时系统在 sendEvent 中运行自己的跟踪循环，期间消息循环不会前进
+- (void)windowWillStartLiveResize:(NSNotification*)notification
+{
+    PauseWatchdog(true);
+}
+- (void)windowDidEndLiveResize:(NSNotification*)notification
+{
+    PauseWatchdog(false);
+}
 @end
 
 ModifierKey translateModifiers(int flags)
@@ -335,7 +529,12 @@ Keys handleKeyEvent(NSEvent* event, ModifierKey* specialKeys)
 
 void tk::DispatchEvent(Window* win, Event* e)
 {
-    win->OnEvent(e);
+    PublishWindowSnapshot(win, e);
+
+    if (win->eventQueue != nullptr)
+        win->eventQueue->Push(win, e);
+    else
+        win->OnEvent(e);
 
     if (e->type == EventType::Closed && win->nativeWindow)
     {
@@ -344,10 +543,18 @@ void tk::DispatchEvent(Window* win, Event* e)
     }
 }
 
+Window* WindowFromNSWindow(NSWindow* nswin)
+{
+    NativeWindowDelegate* delegate = (NativeWindowDelegate*)[nswin delegate];
+    return [delegate getWindow];
+}
+
 bool DispatchEvent(NSWindow* nswin, NSEvent* event)
 {
     NativeWindowDelegate* delegate = (NativeWindowDelegate*)[nswin delegate];
     Window* window = [delegate getWindow];
+    if (window == nullptr)
+        return false;
 
     NSEventType eventType = [event type];
 
@@ -355,6 +562,9 @@ bool DispatchEvent(NSWindow* nswin, NSEvent* event)
     {
         case NSEventTypeMouseEntered:
         {
+            if (!window->IsSubscribed(EventType::MouseEnter))
+                break;
+
             Event e;
             e.type = EventType::MouseEnter;
             DispatchEvent(window, &e);
@@ -362,6 +572,9 @@ bool DispatchEvent(NSWindow* nswin, NSEvent* event)
         break;
         case NSEventTypeMouseExited:
         {
+            if (!window->IsSubscribed(EventType::MouseExit))
+                break;
+
             Event e;
             e.type = EventType::MouseExit;
             DispatchEvent(window, &e);
@@ -420,6 +633,10 @@ bool DispatchEvent(NSWindow* nswin, NSEvent* event)
         case NSEventTypeRightMouseDragged:
         case NSEventTypeOtherMouseDragged:
         {
+            // 拖动事件不受 acceptsMouseMovedEvents 控制，需要在这里过滤
+            if (!window->IsSubscribed(EventType::MouseMove))
+                break;
+
             Event e;
             e.type = EventType::MouseMove;
             DispatchEvent(window, &e);
@@ -441,21 +658,6 @@ bool DispatchEvent(NSWindow* nswin, NSEvent* event)
 
             if (key != Keys::None)
             {
-                bool ctrl = ((int)modifiers & (int)ModifierKey::LeftCtrl) != 0 || ((int)modifiers & (int)ModifierKey::RightCtrl) != 0;
-                NSString* str = [event characters];
-                int len = (int)[str length];
-                for (int i = 0; i < len; i++)
-                {
-                    int c = [str characterAtIndex:i];
-                    if (!ctrl && !(c >= 0xF700 && c <= 0xFFFF) && c != 127)
-                    {
-                        InputEvent e;
-                        e.type = EventType::Input;
-                        e.Char = (unsigned int)c;
-                        DispatchEvent(window, &e);
-                    }
-                }
-
                 if ([event isARepeat])
                 {
                     KeyEvent e;
@@ -505,61 +707,173 @@ bool DispatchEvent(NSWindow* nswin, NSEvent* event)
     return false;
 }
 
+static NSUInteger ToNativeStyle(NSUInteger winStyle, int32_t style)
+{
+    if (style & WINDOW_NOTITLE)
+        winStyle &= ~NSWindowStyleMaskTitled;
+    else
+        winStyle |= NSWindowStyleMaskTitled;
+
+    if (style & WINDOW_BUTTON_MIN)
+        winStyle |= NSWindowStyleMaskMiniaturizable;
+    else
+        winStyle &= ~NSWindowStyleMaskMiniaturizable;
+
+    if (style & WINDOW_RESIZABLE)
+        winStyle |= NSWindowStyleMaskResizable;
+    else
+        winStyle &= ~NSWindowStyleMaskResizable;
+
+    return winStyle;
+}
+
 void Window::OnStyleChanged()
 {
     if (nativeWindow != NULL)
     {
         id window = (id)GetHandle();
-        NSUInteger winStyle = [window styleMask];
-        if (style & WINDOW_NOTITLE)
-            winStyle &= ~NSWindowStyleMaskTitled;
-        else
-            winStyle |= NSWindowStyleMaskTitled;
 
-        if (style & WINDOW_BUTTON_MIN)
-            winStyle |= NSWindowStyleMaskMiniaturizable;
-        else
-            winStyle &= ~NSWindowStyleMaskMiniaturizable;
+        // 独占全屏时只记录，退出时再应用
+        if (nativeWindow->display != 0)
+        {
+            nativeWindow->savedStyle = ToNativeStyle(nativeWindow->savedStyle, style);
+            return;
+        }
 
-        if (style & WINDOW_BUTTON_MAX)
-            [[window standardWindowButton:NSWindowZoomButton] setEnabled:YES];
-        else
-            [[window standardWindowButton:NSWindowZoomButton] setEnabled:NO];
+        NSUInteger winStyle = ToNativeStyle([window styleMask], style);
+        if (winStyle != [window styleMask])
+            [window setStyleMask:winStyle];
 
-        if (style & WINDOW_RESIZABLE)
-            winStyle |= NSWindowStyleMaskResizable;
-        else
-            winStyle &= ~NSWindowStyleMaskResizable;
+        // 改变 styleMask 可能重建标题栏按钮，所以最后设置
+        [[window standardWindowButton:NSWindowZoomButton] setEnabled:(style & WINDOW_BUTTON_MAX) ? YES : NO];
+    }
+}
+
+namespace tk
+{
+// 供 NativeWindowDelegate 调用
+bool RecycleWindow(Window* win)
+{
+    return win->RecycleImpl();
+}
+} // namespace tk
 
-        [window setStyleMask:winStyle];
+// 由 WindowPool 调用，窗口已经与 Window 解除关联
+void DestroyPooledWindow(NativeWindow* native)
+{
+    delete native;
+}
+
+bool Window::RecycleImpl()
+{
+    NSWindow* window = nativeWindow->window;
+    if ([window isMiniaturized] || [window isZoomed] || GetWindowState() == WindowState::Fullscreen)
+        return false;
+
+    [window orderOut:nil];
+    NSWindow* parent = [window parentWindow];
+    if (parent != nil)
+        [parent removeChildWindow:window];
+    [window setLevel:NSNormalWindowLevel];
+    [(NativeWindowDelegate*)nativeWindow->delegate setWindow:nullptr];
+
+    auto native = nativeWindow;
+    nativeWindow = nullptr;
+
+    Event e;
+    e.type = EventType::Closed;
+    DispatchEvent(this, &e);
+
+    ReleasePooledWindow(native, style);
+    return true;
+}
+
+void Window::UpdateEventMaskImpl()
+{
+    @autoreleasepool
+    {
+        NSWindow* window = nativeWindow->window;
+        NSView* view = [window contentView];
+        bool motion = IsSubscribed(EventType::MouseMove);
+        bool crossing = IsSubscribed(EventType::MouseEnter) || IsSubscribed(EventType::MouseExit);
+
+        [window setAcceptsMouseMovedEvents:motion ? YES : NO];
+
+        // 跟踪区域不能修改选项，只能替换；都没有订阅时不保留跟踪区域
+        for (NSTrackingArea* area in [NSArray arrayWithArray:[view trackingAreas]])
+        {
+            if ([area owner] == view)
+                [view removeTrackingArea:area];
+        }
+
+        if (!motion && !crossing)
+            return;
+
+        NSTrackingAreaOptions options = NSTrackingActiveAlways | NSTrackingInVisibleRect;
+        if (motion)
+            options |= NSTrackingMouseMoved;
+        if (crossing)
+            options |= NSTrackingMouseEnteredAndExited;
+
+        NSTrackingArea* trackingArea = [[NSTrackingArea alloc] initWithRect:[view bounds] options:options owner:view userInfo:nil];
+        [view addTrackingArea:trackingArea];
     }
 }
 
 bool Window::CreateImpl(Window* parent, std::string title, const Rect<float>& rect)
 {
+    EnsureBackend();
+
+    auto pooled = HasStyle(WINDOW_POOLED) ? AcquirePooledWindow(style) : nullptr;
+    if (pooled != nullptr)
+    {
+        @autoreleasepool
+        {
+            // 在关联之前调整位置，不会向新的 Window 发送 Resize
+            NSWindow* window = pooled->window;
+            [window setTitle:[NSString stringWithUTF8String:title.c_str()]];
+            [window setFrame:[window frameRectForContentRect:NSMakeRect(rect.X, rect.Y, rect.Width, rect.Height)] display:NO];
+            [(NativeWindowDelegate*)pooled->delegate setWindow:this];
+            nativeWindow = pooled;
+            UpdateEventMaskImpl();
+            if (parent != nullptr && parent->GetHandle() != nullptr)
+                [(id)parent->GetHandle() addChildWindow:window ordered:NSWindowAbove];
+            if (!IsCreatingWindows())
+                [window makeKeyAndOrderFront:nil];
+
+            Event e;
+            e.type = EventType::Create;
+            e.result = 0;
+            DispatchEvent(this, &e);
+
+            this->OnCreate();
+        }
+
+        // 池按样式分组，复用的窗口样式已经一致
+        SetTransparencyImpl(1);
+        RecordFirstWindow();
+        return true;
+    }
+
     @autoreleasepool
     {
         NSView* view = [[NativeView alloc] initWithFrame:NSMakeRect(0, 0, rect.Width, rect.Height)];
 
-        NSUInteger style = NSWindowStyleMaskTitled |
-                           NSWindowStyleMaskMiniaturizable |
-                           NSWindowStyleMaskResizable | NSWindowStyleMaskClosable;
-        id window = [[NSWindow alloc]
+        // 直接以最终的样式创建，之后的 OnStyleChanged 不需要再修改 styleMask
+        // 批量创建时推迟分配窗口的后备存储，到 AppShowWindows 显示时才创建
+        bool batch = IsCreatingWindows();
+        id window = [[NativeNSWindow alloc]
             initWithContentRect:NSMakeRect(rect.X, rect.Y, rect.Width, rect.Height)
-                      styleMask:style
+                      styleMask:ToNativeStyle(NSWindowStyleMaskClosable, style)
                         backing:NSBackingStoreBuffered
-                          defer:NO];
+                          defer:batch ? YES : NO];
         [window setTitle:[NSString stringWithUTF8String:title.c_str()]];
         [window setContentView:view];
         [window makeFirstResponder:view];
-        [window makeKeyAndOrderFront:nil];
-        [window setAcceptsMouseMovedEvents:YES];
+        if (!batch)
+            [window makeKeyAndOrderFront:nil];
         [NSWindow setAllowsAutomaticWindowTabbing:NO];
 
-        NSTrackingAreaOptions options = (NSTrackingActiveAlways | NSTrackingInVisibleRect | NSTrackingMouseEnteredAndExited | NSTrackingMouseMoved);
-        NSTrackingArea* trackingArea = [[NSTrackingArea alloc] initWithRect:[view bounds] options:options owner:view userInfo:nil];
-        [view addTrackingArea:trackingArea];
-
         id _windowDelegate = [[NativeWindowDelegate alloc] init];
         [_windowDelegate setWindow:this];
         [window setDelegate:_windowDelegate];
@@ -572,6 +886,7 @@ bool Window::CreateImpl(Window* parent, std::string title, const Rect<float>& re
         nativeWindow = new NativeWindow();
         nativeWindow->window = window;
         nativeWindow->delegate = _windowDelegate;
+        UpdateEventMaskImpl();
 
         Event e;
         e.type = EventType::Create;
@@ -581,27 +896,45 @@ bool Window::CreateImpl(Window* parent, std::string title, const Rect<float>& re
         this->OnCreate();
     }
 
-    SetTransparency(1);
+    SetTransparencyImpl(1);
 
     OnStyleChanged();
 
+    RecordFirstWindow();
+
     return nativeWindow != NULL;
 }
 
-void Window::Show()
+void Window::ShowImpl()
 {
     id window = (id)GetHandle();
     [window setIsVisible:YES];
 }
 
-void Window::Hide()
+void Window::HideImpl()
 {
     id window = (id)GetHandle();
     [window setIsVisible:NO];
 }
 
-void Window::Close()
+void Window::CloseImpl()
 {
+    if (nativeWindow == nullptr)
+        return;
+
+    // [window close] 不经过 windowShouldClose，回收前同样先分发 Closing，被拒绝时保留窗口
+    if (HasStyle(WINDOW_POOLED))
+    {
+        Event e;
+        e.type = EventType::Closing;
+        DispatchEvent(this, &e);
+        if (e.result != 0 || nativeWindow == nullptr)
+            return;
+
+        if (RecycleImpl())
+            return;
+    }
+
     id window = (id)GetHandle();
     [window close];
 }
@@ -633,12 +966,12 @@ tk::Point<float> Window::GetMousePosition() const
     return {(float)std::clamp((float)x, 0.f, (float)adjustFrame.size.width), (float)std::clamp((float)y, 0.0f, (float)adjustFrame.size.height)};
 }
 
-void Window::SetMousePosition(const tk::Point<float>& p)
+void Window::SetMousePositionImpl(const tk::Point<float>& p)
 {
     // TODO:
 }
 
-void Window::SetCursor(const Cursor& cur)
+void Window::SetCursorImpl(const Cursor& cur)
 {
     NSCursor* _cursor = [NSCursor arrowCursor];
     switch (cur)
@@ -695,7 +1028,7 @@ bool Window::GetMouseCapture() const
     return false;
 }
 
-void Window::SetMouseCapture(bool value)
+void Window::SetMouseCaptureImpl(bool value)
 {
     // TODO:
 }
@@ -708,10 +1041,57 @@ bool Window::IsVisible() const
 
 bool Window::GetFocus() const
 {
-    return false;
+    id window = (id)GetHandle();
+    return [window isKeyWindow];
+}
+
+bool Window::CaptureImpl(const CaptureBuffer& buffer, int32_t x, int32_t y) const
+{
+    NSWindow* window = (NSWindow*)GetHandle();
+    NSView* view = [window contentView];
+    CGFloat scale = [window backingScaleFactor];
+
+    // CGWindowList 使用以主屏幕左上角为原点的全局坐标（点）
+    NSRect client = [window convertRectToScreen:[view convertRect:[view bounds] toView:nil]];
+    CGFloat primaryHeight = [[[NSScreen screens] firstObject] frame].size.height;
+    CGRect bounds = CGRectMake(client.origin.x + x / scale,
+                               primaryHeight - NSMaxY(client) + y / scale,
+                               buffer.Width / scale,
+                               buffer.Height / scale);
+
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wdeprecated-declarations"
+    CGImageRef image = CGWindowListCreateImage(bounds, kCGWindowListOptionIncludingWindow, (CGWindowID)[window windowNumber],
+                                               kCGWindowImageBoundsIgnoreFraming | kCGWindowImageBestResolution);
+#pragma clang diagnostic pop
+    if (image == NULL)
+        return false;
+
+    // 直接绘制到调用者的缓冲区，不经过中间位图
+    CGColorSpaceRef space = CGColorSpaceCreateWithName(kCGColorSpaceSRGB);
+    CGContextRef context = CGBitmapContextCreate(buffer.Data, buffer.Width, buffer.Height, 8, buffer.Stride, space,
+                                                 kCGImageAlphaPremultipliedFirst | kCGBitmapByteOrder32Little);
+    CGColorSpaceRelease(space);
+    if (context == NULL)
+    {
+        CGImageRelease(image);
+        return false;
+    }
+
+    CGContextSetBlendMode(context, kCGBlendModeCopy);
+    CGContextDrawImage(context, CGRectMake(0, 0, buffer.Width, buffer.Height), image);
+    CGContextRelease(context);
+    CGImageRelease(image);
+    return true;
 }
 
-void Window::SetFocus(bool value)
+bool Window::IsOccluded() const
+{
+    NSWindow* window = (NSWindow*)GetHandle();
+    return ([window occlusionState] & NSWindowOcclusionStateVisible) == 0;
+}
+
+void Window::SetFocusImpl(bool value)
 {
     id window = (id)GetHandle();
     [window makeKeyAndOrderFront:nil];
@@ -723,7 +1103,7 @@ std::string Window::GetTitle() const
     return std::string([[window title] UTF8String]);
 }
 
-void Window::SetTitle(const std::string& value)
+void Window::SetTitleImpl(const std::string& value)
 {
     id window = (id)GetHandle();
     [window setTitle:[NSString stringWithUTF8String:value.c_str()]];
@@ -737,7 +1117,7 @@ tk::Rect<float> Window::GetRect() const
     return {(float)rect.origin.x, (float)(screenRect.size.height - rect.origin.y), (float)rect.size.width, (float)rect.size.height};
 }
 
-void Window::SetRect(const tk::Rect<float>& value)
+void Window::SetRectImpl(const tk::Rect<float>& value)
 {
     // if (GetWindowState() == WindowState::Maximized)
     //     return;
@@ -754,7 +1134,7 @@ tk::Size<float> Window::GetClientSize() const
     return {(float)[view bounds].size.width, (float)[view bounds].size.height};
 }
 
-void Window::SetClientSize(const tk::Size<float>& value)
+void Window::SetClientSizeImpl(const tk::Size<float>& value)
 {
     // if (GetWindowState() == WindowState::Maximized)
     //     return;
@@ -765,31 +1145,72 @@ void Window::SetClientSize(const tk::Size<float>& value)
     dst_rect.origin = cur_rect.origin;
 
     NSRect screenRect = [[NSScreen mainScreen] visibleFrame];
-    SetRect({(float)dst_rect.origin.x, (float)(screenRect.size.height - dst_rect.origin.y), (float)dst_rect.size.width, (float)dst_rect.size.height});
+    SetRectImpl({(float)dst_rect.origin.x, (float)(screenRect.size.height - dst_rect.origin.y), (float)dst_rect.size.width, (float)dst_rect.size.height});
 }
 
 WindowState Window::GetWindowState() const
 {
     id window = (id)GetHandle();
 
-    if ([window isZoomed])
-        return WindowState::Maximized;
-
     if ([window isMiniaturized])
         return WindowState::Minimized;
 
+    if (([window styleMask] & NSWindowStyleMaskFullScreen) != 0 || (nativeWindow != nullptr && nativeWindow->display != 0))
+        return WindowState::Fullscreen;
+
+    if ([window isZoomed])
+        return WindowState::Maximized;
+
     return WindowState::Normal;
 }
 
-void Window::SetWindowState(WindowState state)
+// 捕获显示器后只有不低于 CGShieldingWindowLevel 的窗口可见，系统不再合成其他窗口
+static bool EnterExclusiveFullscreen(NativeWindow* native)
 {
-    id window = (id)GetHandle();
+    NSWindow* window = native->window;
+    NSScreen* screen = [window screen] != nil ? [window screen] : [NSScreen mainScreen];
+    CGDirectDisplayID display = [[[screen deviceDescription] objectForKey:@"NSScreenNumber"] unsignedIntValue];
+    if (CGDisplayCapture(display) != kCGErrorSuccess)
+        return false;
+
+    native->display = display;
+    native->savedStyle = [window styleMask];
+    native->savedFrame = [window frame];
+    native->savedLevel = [window level];
+
+    [window setStyleMask:NSWindowStyleMaskBorderless];
+    [window setLevel:CGShieldingWindowLevel()];
+    [window setFrame:[screen frame] display:YES];
+    [window makeKeyAndOrderFront:nil];
+    return true;
+}
+
+static void ExitExclusiveFullscreen(NativeWindow* native)
+{
+    NSWindow* window = native->window;
+    [window setStyleMask:native->savedStyle];
+    [window setLevel:native->savedLevel];
+    [window setFrame:native->savedFrame display:YES];
+
+    CGDisplayRelease(native->display);
+    native->display = 0;
+}
+
+void Window::SetWindowStateImpl(WindowState state)
+{
+    NSWindow* window = (id)GetHandle();
+    bool system = ([window styleMask] & NSWindowStyleMaskFullScreen) != 0;
+
+    if (state != WindowState::Fullscreen && nativeWindow->display != 0)
+        ExitExclusiveFullscreen(nativeWindow);
 
     switch (state)
     {
         case WindowState::Normal:
             if ([window isMiniaturized])
                 [window setIsMiniaturized:NO];
+            else if (system)
+                [window toggleFullScreen:nil];
             else if ([window isZoomed])
                 [window setIsZoomed:NO];
             break;
@@ -797,9 +1218,37 @@ void Window::SetWindowState(WindowState state)
             [window miniaturize:nil];
             break;
         case WindowState::Maximized:
-            [window zoom:nil];
+            // 退出系统全屏是异步的，之后才能最大化
+            if (system)
+                [window toggleFullScreen:nil];
+            else if (![window isZoomed])
+                [window zoom:nil];
+            break;
+        case WindowState::Fullscreen:
+            if ([window isMiniaturized])
+                [window deminiaturize:nil];
+
+            if (fullscreenMode == FullscreenMode::Exclusive)
+            {
+                // 系统全屏需要先退出
+                if (system || nativeWindow->display != 0)
+                    break;
+
+                EnterExclusiveFullscreen(nativeWindow);
+            }
+            else if (!system)
+            {
+                if (nativeWindow->display != 0)
+                    ExitExclusiveFullscreen(nativeWindow);
+
+                [window setCollectionBehavior:[window collectionBehavior] | NSWindowCollectionBehaviorFullScreenPrimary];
+                [window toggleFullScreen:nil];
+            }
             break;
     }
+
+    // 系统全屏的切换通过 windowDidEnterFullScreen、windowDidExitFullScreen 通知
+    NotifyWindowState(this);
 }
 
 bool Window::GetTopMost() const
@@ -808,7 +1257,7 @@ bool Window::GetTopMost() const
     return [window level] == NSMainMenuWindowLevel;
 }
 
-void Window::SetTopMost(bool value)
+void Window::SetTopMostImpl(bool value)
 {
     id window = (id)GetHandle();
     if (value)
@@ -823,13 +1272,13 @@ float Window::GetTransparency() const
     return [window alphaValue];
 }
 
-void Window::SetTransparency(float alpha)
+void Window::SetTransparencyImpl(float alpha)
 {
     id window = (id)GetHandle();
     [window setAlphaValue:alpha];
 }
 
-void Window::MoveToCenter()
+void Window::MoveToCenterImpl()
 {
     if (GetWindowState() != WindowState::Normal)
         return;
@@ -840,11 +1289,15 @@ void Window::MoveToCenter()
 
 Window::~Window()
 {
+    if (nativeWindow != nullptr && HasStyle(WINDOW_POOLED))
+        RecycleImpl();
+
     if (nativeWindow != nullptr)
     {
         delete nativeWindow;
         nativeWindow = nullptr;
     }
+    SetEventQueue(nullptr);
 }
 #endif
 #endif
\ No newline at end of file
@@ -1,8 +1,11 @@
 ﻿#ifdef _WIN32
 #include <algorithm>
 #include <Windows.h>
+#include <dwmapi.h>
+#include <imm.h>
 #include "Window.h"
 #include "Application.h"
+#include "EventQueue.h"
 
 using namespace tk;
 
@@ -36,6 +39,13 @@ std::string FromNative(const TCHAR* str)
     return std::string(BUFFER2);
 }
 
+void EnsureBackend();
+void RecordFirstWindow();
+void InvalidateMonitors();
+void PauseWatchdog(bool paused);
+NativeWindow* AcquirePooledWindow(int32_t style);
+void ReleasePooledWindow(NativeWindow* native, int32_t style);
+
 namespace tk
 {
 void RunLoop(Application* app, Window* win);
@@ -43,6 +53,15 @@ void RunLoop(Application* app, Window* win);
 struct NativeWindow
 {
     HWND hWnd;
+    WCHAR highSurrogate = 0;
+
+    // 进入全屏前的样式和位置，退出时还原
+    bool fullscreen = false;
+    bool exclusive = false;
+    LONG_PTR savedStyle = 0;
+    LONG_PTR savedExStyle = 0;
+    WINDOWPLACEMENT placement = {sizeof(WINDOWPLACEMENT)};
+    WCHAR device[CCHDEVICENAME] = {}; // 独占全屏锁定了显示模式的显示器
 
     NativeWindow(Window* win, HWND hWnd)
         : hWnd(hWnd)
@@ -52,8 +71,18 @@ struct NativeWindow
 
     ~NativeWindow()
     {
+        ReleaseDisplay();
         SetWindowLongPtrW(hWnd, GWLP_USERDATA, (LONG_PTR) nullptr);
     }
+
+    void ReleaseDisplay()
+    {
+        if (device[0] != 0)
+        {
+            ChangeDisplaySettingsExW(device, NULL, NULL, 0, NULL);
+            device[0] = 0;
+        }
+    }
 };
 
 struct TranslateKeyModifiers
@@ -267,9 +296,94 @@ Keys translateKey(uint8_t keyCode)
 
 void DispatchEvent(Window* win, Event* e)
 {
+    PublishWindowSnapshot(win, e);
+
+    if (win->eventQueue != nullptr)
+        return win->eventQueue->Push(win, e);
+
     win->OnEvent(e);
 }
 
+static size_t EncodeUtf8(uint32_t c, char* out)
+{
+    if (c < 0x80)
+    {
+        out[0] = (char)c;
+        return 1;
+    }
+    if (c < 0x800)
+    {
+        out[0] = (char)(0xC0 | (c >> 6));
+        out[1] = (char)(0x80 | (c & 0x3F));
+        return 2;
+    }
+    if (c < 0x10000)
+    {
+        out[0] = (char)(0xE0 | (c >> 12));
+        out[1] = (char)(0x80 | ((c >> 6) & 0x3F));
+        out[2] = (char)(0x80 | (c & 0x3F));
+        return 3;
+    }
+    out[0] = (char)(0xF0 | (c >> 18));
+    out[1] = (char)(0x80 | ((c >> 12) & 0x3F));
+    out[2] = (char)(0x80 | ((c >> 6) & 0x3F));
+    out[3] = (char)(0x80 | (c & 0x3F));
+    return 4;
+}
+
+static void AppendCodePoint(Window* win, uint32_t c)
+{
+    // 控制字符通过 KeyDown 处理，不作为文本
+    if (c < 0x20 || c == 0x7F || c > 0x10FFFF || (c >= 0xD800 && c <= 0xDFFF))
+        return;
+
+    char buffer[4];
+    AppendTextInput(win, std::string_view(buffer, EncodeUtf8(c, buffer)));
+}
+
+static std::string ToUtf8(const WCHAR* str, int32_t len)
+{
+    std::string ret;
+    int32_t size = WideCharToMultiByte(CP_UTF8, 0, str, len, NULL, 0, NULL, NULL);
+    if (size > 0)
+    {
+        ret.resize(size);
+        WideCharToMultiByte(CP_UTF8, 0, str, len, ret.data(), size, NULL, NULL);
+    }
+    return ret;
+}
+
+static void DispatchComposition(Window* win, HWND hWnd)
+{
+    std::wstring text;
+    LONG cursor = 0;
+
+    HIMC himc = ImmGetContext(hWnd);
+    if (himc != NULL)
+    {
+        LONG bytes = ImmGetCompositionStringW(himc, GCS_COMPSTR, NULL, 0);
+        if (bytes > 0)
+        {
+            text.resize(bytes / sizeof(WCHAR));
+            ImmGetCompositionStringW(himc, GCS_COMPSTR, text.data(), bytes);
+        }
+        cursor = ImmGetCompositionStringW(himc, GCS_CURSORPOS, NULL, 0);
+        ImmReleaseContext(hWnd, himc);
+    }
+
+    cursor = std::clamp<LONG>(cursor, 0, (LONG)text.size());
+    std::string utf8 = ToUtf8(text.data(), (int32_t)text.size());
+
+    // 先把已提交的文本发出去，保证顺序
+    FlushTextInput(win);
+
+    TextCompositionEvent e;
+    e.type = EventType::TextComposition;
+    e.Text = utf8;
+    e.Cursor = (int32_t)ToUtf8(text.data(), cursor).size();
+    DispatchEvent(win, &e);
+}
+
 LRESULT WINAPI WndProc(HWND hWnd, UINT msg, WPARAM wParam, LPARAM lParam)
 {
     if (msg == WM_CREATE)
@@ -293,8 +407,17 @@ LRESULT WINAPI WndProc(HWND hWnd, UINT msg, WPARAM wParam, LPARAM lParam)
                 DispatchEvent(win, &m);
                 break;
             }
+            case WM_WINDOWPOSCHANGED:
+                // WM_SHOWWINDOW 在 WS_VISIBLE 改变之前发送，快照中的显示状态在这里重新发布
+                if (((WINDOWPOS*)lParam)->flags & (SWP_SHOWWINDOW | SWP_HIDEWINDOW))
+                    PublishWindowSnapshot(win);
+                break;
             case WM_MOUSEMOVE:
             {
+                // 没有订阅时不构造事件，也不进入事件队列
+                if (!win->IsSubscribed(EventType::MouseMove))
+                    break;
+
                 Event e;
                 e.type = EventType::MouseMove;
                 DispatchEvent(win, &e);
@@ -391,16 +514,61 @@ LRESULT WINAPI WndProc(HWND hWnd, UINT msg, WPARAM wParam, LPARAM lParam)
             }
             case WM_CHAR:
             {
-                // You can also use ToAscii()+GetKeyboardState() to retrieve characters.
-                if (wParam > 0 && wParam < 0x10000)
+                // 文本在本帧内累积，由 RunLoop 合并为一个 TextInput 事件分发
+                if (win->nativeWindow == nullptr)
+                    break;
+
+                WCHAR c = (WCHAR)wParam;
+                if (IS_HIGH_SURROGATE(c))
                 {
-                    InputEvent m;
-                    m.type = EventType::Input;
-                    m.Char = (uint32_t)wParam;
-                    DispatchEvent(win, &m);
+                    win->nativeWindow->highSurrogate = c;
+                }
+                else if (IS_LOW_SURROGATE(c))
+                {
+                    WCHAR high = win->nativeWindow->highSurrogate;
+                    win->nativeWindow->highSurrogate = 0;
+                    if (high != 0)
+                        AppendCodePoint(win, 0x10000 + (((uint32_t)high - 0xD800) << 10) + ((uint32_t)c - 0xDC00));
+                }
+                else
+                {
+                    win->nativeWindow->highSurrogate = 0;
+                    AppendCodePoint(win, c);
                 }
                 break;
             }
+            case WM_UNICHAR:
+            {
+                if (wParam == UNICODE_NOCHAR)
+                    return TRUE;
+
+                AppendCodePoint(win, (uint32_t)wParam);
+                return 0;
+            }
+            case WM_IME_COMPOSITION:
+            {
+                // 结果串由 DefWindowProc 转成 WM_CHAR，这里只处理预编辑文本
+                if (lParam & GCS_COMPSTR)
+                    DispatchComposition(win, hWnd);
+                break;
+            }
+            case WM_IME_ENDCOMPOSITION:
+            {
+                FlushTextInput(win);
+
+                TextCompositionEvent e;
+                e.type = EventType::TextComposition;
+                e.Cursor = 0;
+                DispatchEvent(win, &e);
+                break;
+            }
+            case WM_DISPLAYCHANGE:
+                InvalidateMonitors();
+                break;
+            case WM_SETTINGCHANGE:
+                if (wParam == SPI_SETWORKAREA)
+                    InvalidateMonitors();
+                break;
             case WM_DPICHANGED:
             {
                 LPRECT r = (LPRECT)lParam;
@@ -416,6 +584,27 @@ LRESULT WINAPI WndProc(HWND hWnd, UINT msg, WPARAM wParam, LPARAM lParam)
                 Event e;
                 e.type = EventType::Resize;
                 DispatchEvent(win, &e);
+                NotifyWindowState(win);
+                break;
+            }
+            case WM_SETFOCUS:
+            case WM_KILLFOCUS:
+                PublishWindowSnapshot(win);
+                break;
+            // 移动、调整大小和菜单在 DefWindowProc 的模态循环中进行，期间消息循环不会前进
+            case WM_ENTERSIZEMOVE:
+            case WM_ENTERMENULOOP:
+                PauseWatchdog(true);
+                break;
+            case WM_EXITSIZEMOVE:
+            case WM_EXITMENULOOP:
+                PauseWatchdog(false);
+                break;
+            case WM_ACTIVATEAPP:
+            {
+                // 独占全屏的置顶窗口会挡住切换到的程序
+                if (wParam == FALSE && win->nativeWindow != nullptr && win->nativeWindow->exclusive)
+                    ShowWindow(hWnd, SW_MINIMIZE);
                 break;
             }
             case WM_CLOSE:
@@ -425,6 +614,9 @@ LRESULT WINAPI WndProc(HWND hWnd, UINT msg, WPARAM wParam, LPARAM lParam)
                 DispatchEvent(win, &e);
                 if (e.result != 0)
                     return 0;
+
+                if (win->HasStyle(WINDOW_POOLED) && win->RecycleImpl())
+                    return 0;
                 break;
             }
             case WM_DESTROY:
@@ -449,30 +641,79 @@ LRESULT WINAPI WndProc(HWND hWnd, UINT msg, WPARAM wParam, LPARAM lParam)
 }
 } // namespace tk
 
+// 由 WindowPool 调用，窗口已经与 Window 解除关联
+void DestroyPooledWindow(NativeWindow* native)
+{
+    HWND hWnd = native->hWnd;
+    delete native;
+    DestroyWindow(hWnd);
+}
+
+bool Window::RecycleImpl()
+{
+    // 隐藏的窗口无法还原最大化、最小化状态，这种情况直接销毁
+    HWND hWnd = (HWND)GetHandle();
+    if (IsIconic(hWnd) || IsZoomed(hWnd) || nativeWindow->fullscreen)
+        return false;
+
+    ShowWindow(hWnd, SW_HIDE);
+    if (::GetCapture() == hWnd)
+        ::ReleaseCapture();
+    SetWindowPos(hWnd, HWND_NOTOPMOST, 0, 0, 0, 0, SWP_NOMOVE | SWP_NOSIZE | SWP_NOACTIVATE);
+    SetWindowLongPtrW(hWnd, GWLP_HWNDPARENT, 0);
+    SetWindowLongPtrW(hWnd, GWLP_USERDATA, 0);
+
+    auto native = nativeWindow;
+    nativeWindow = nullptr;
+    native->highSurrogate = 0;
+
+    Event e;
+    e.type = EventType::Closed;
+    DispatchEvent(this, &e);
+
+    ReleasePooledWindow(native, style);
+    return true;
+}
+
+void Window::UpdateEventMaskImpl()
+{
+    // Win32 无法退订 WM_MOUSEMOVE，未订阅的消息在 WndProc 中直接丢弃
+}
+
+static LONG ToNativeStyle(LONG winStyle, int32_t style)
+{
+    if (style & WINDOW_NOTITLE)
+        winStyle &= ~WS_CAPTION;
+    else
+        winStyle |= WS_CAPTION;
+
+    if (style & WINDOW_BUTTON_MIN)
+        winStyle |= WS_MINIMIZEBOX;
+    else
+        winStyle &= ~WS_MINIMIZEBOX;
+
+    if (style & WINDOW_BUTTON_MAX)
+        winStyle |= WS_MAXIMIZEBOX;
+    else
+        winStyle &= ~WS_MAXIMIZEBOX;
+
+    if (style & WINDOW_RESIZABLE)
+        winStyle |= WS_THICKFRAME;
+    else
+        winStyle &= ~WS_THICKFRAME;
+
+    return winStyle;
+}
+
 void Window::OnStyleChanged()
 {
     if (nativeWindow != NULL)
     {
-        auto winStyle = GetWindowLong((HWND)GetHandle(), GWL_STYLE);
-        if (style & WINDOW_NOTITLE)
-            winStyle &= ~WS_CAPTION;
-        else
-            winStyle |= WS_CAPTION;
-
-        if (style & WINDOW_BUTTON_MIN)
-            winStyle |= WS_MINIMIZEBOX;
-        else
-            winStyle &= ~WS_MINIMIZEBOX;
-
-        if (style & WINDOW_BUTTON_MAX)
-            winStyle |= WS_MAXIMIZEBOX;
-        else
-            winStyle &= ~WS_MAXIMIZEBOX;
-
-        if (style & WINDOW_RESIZABLE)
-            winStyle |= WS_THICKFRAME;
-        else
-            winStyle &= ~WS_THICKFRAME;
+        // 样式没有变化时跳过 SWP_FRAMECHANGED，它会重新计算并重绘非客户区
+        auto oldStyle = GetWindowLong((HWND)GetHandle(), GWL_STYLE);
+        auto winStyle = ToNativeStyle(oldStyle, style);
+        if (winStyle == oldStyle)
+            return;
 
         SetWindowLong((HWND)GetHandle(), GWL_STYLE, winStyle);
         SetWindowPos((HWND)GetHandle(), NULL, 0, 0, 0, 0, SWP_NOSIZE | SWP_NOMOVE | SWP_NOZORDER | SWP_FRAMECHANGED);
@@ -481,13 +722,38 @@ void Window::OnStyleChanged()
 
 bool Window::CreateImpl(Window* parent, std::string title, const Rect<float>& rect)
 {
-    int32_t win_style = WS_OVERLAPPEDWINDOW;
-    WNDCLASSEX wc = {sizeof(WNDCLASSEX), CS_CLASSDC, ::WndProc, 0L, 0L, GetModuleHandle(NULL), NULL, LoadCursor(NULL, IDC_ARROW), NULL, NULL, TEXT("Window"), NULL};
-    RegisterClassEx(&wc);
+    EnsureBackend();
+
+    // 窗口类只需要注册一次
+    static ATOM windowClass = 0;
+    if (windowClass == 0)
+    {
+        // 每个窗口使用独立的 DC，才能分别设置 OpenGL 像素格式
+        WNDCLASSEX wc = {sizeof(WNDCLASSEX), CS_OWNDC, ::WndProc, 0L, 0L, GetModuleHandle(NULL), NULL, LoadCursor(NULL, IDC_ARROW), NULL, NULL, TEXT("Window"), NULL};
+        windowClass = RegisterClassEx(&wc);
+    }
+
+    // 直接以最终的样式创建，之后的 OnStyleChanged 不需要再修改
+    int32_t win_style = ToNativeStyle(WS_OVERLAPPEDWINDOW, style);
     float dpi = GetDpiForSystem() / (float)USER_DEFAULT_SCREEN_DPI;
-    HWND hWnd = CreateWindowEx(WS_EX_LAYERED, TEXT("Window"), ToNative(title), win_style, (int)(rect.X * dpi), (int)(rect.Y * dpi), (int)(rect.Width * dpi), (int)(rect.Height * dpi), parent == nullptr ? NULL : (HWND)(parent->GetHandle()), NULL, wc.hInstance, this);
+    HWND parentWnd = parent == nullptr ? NULL : (HWND)(parent->GetHandle());
 
-    this->nativeWindow = new NativeWindow(this, hWnd);
+    // 复用的窗口在关联之前调整位置，不会向新的 Window 发送 Resize
+    auto pooled = HasStyle(WINDOW_POOLED) ? AcquirePooledWindow(style) : nullptr;
+    if (pooled != nullptr)
+    {
+        HWND hWnd = pooled->hWnd;
+        SetWindowText(hWnd, ToNative(title));
+        SetWindowPos(hWnd, NULL, (int)(rect.X * dpi), (int)(rect.Y * dpi), (int)(rect.Width * dpi), (int)(rect.Height * dpi), SWP_NOZORDER | SWP_NOACTIVATE);
+        SetWindowLongPtrW(hWnd, GWLP_HWNDPARENT, (LONG_PTR)parentWnd);
+        SetWindowLongPtrW(hWnd, GWLP_USERDATA, (LONG_PTR)this);
+        this->nativeWindow = pooled;
+    }
+    else
+    {
+        HWND hWnd = CreateWindowEx(WS_EX_LAYERED, TEXT("Window"), ToNative(title), win_style, (int)(rect.X * dpi), (int)(rect.Y * dpi), (int)(rect.Width * dpi), (int)(rect.Height * dpi), parentWnd, NULL, GetModuleHandle(NULL), this);
+        this->nativeWindow = new NativeWindow(this, hWnd);
+    }
 
     Event e;
     e.type = EventType::Create;
@@ -496,26 +762,33 @@ bool Window::CreateImpl(Window* parent, std::string title, const Rect<float>& re
 
     this->OnCreate();
 
-    SetTransparency(1);
+    SetTransparencyImpl(1);
+
+    // 池按样式分组，复用的窗口样式已经一致
+    if (pooled == nullptr)
+        OnStyleChanged();
 
-    OnStyleChanged();
+    RecordFirstWindow();
 
     return nativeWindow != NULL;
 }
 
-void Window::Show()
+void Window::ShowImpl()
 {
     ShowWindow((HWND)GetHandle(), SW_SHOW);
     UpdateWindow((HWND)GetHandle());
 }
 
-void Window::Hide()
+void Window::HideImpl()
 {
     ShowWindow((HWND)GetHandle(), SW_HIDE);
 }
 
-void Window::Close()
+void Window::CloseImpl()
 {
+    if (nativeWindow == nullptr)
+        return;
+
     SendMessage((HWND)GetHandle(), WM_CLOSE, 0, 0);
 }
 
@@ -525,7 +798,7 @@ void Window::ShowDialog()
     bool enable = IsWindowEnabled(parent);
     EnableWindow(parent, false);
 
-    Show();
+    ShowImpl();
 
     RunLoop(Application::Current(), this);
 
@@ -556,7 +829,7 @@ Point<float> Window::GetMousePosition() const
     return {(float)std::clamp(point.x / dpi, 0.f, (float)size.Width), (float)std::clamp(point.y / dpi, 0.f, (float)size.Height)};
 }
 
-void Window::SetMousePosition(const Point<float>& p)
+void Window::SetMousePositionImpl(const Point<float>& p)
 {
     float dpi = GetDpiScale();
     POINT pos = {(int)(p.X * dpi), (int)(p.Y * dpi)};
@@ -564,7 +837,7 @@ void Window::SetMousePosition(const Point<float>& p)
         ::SetCursorPos(pos.x, pos.y);
 }
 
-void Window::SetCursor(const Cursor& cur)
+void Window::SetCursorImpl(const Cursor& cur)
 {
     LPTSTR win32_cursor = IDC_ARROW;
     switch (cur)
@@ -608,7 +881,7 @@ bool Window::GetMouseCapture() const
     return ::GetCapture() == GetHandle();
 }
 
-void Window::SetMouseCapture(bool value)
+void Window::SetMouseCaptureImpl(bool value)
 {
     if (value)
     {
@@ -630,7 +903,72 @@ bool Window::GetFocus() const
     return ::GetFocus() == (HWND)GetHandle();
 }
 
-void Window::SetFocus(bool value)
+#ifndef PW_RENDERFULLCONTENT
+#define PW_RENDERFULLCONTENT 0x00000002
+#endif
+
+bool Window::CaptureImpl(const CaptureBuffer& buffer, int32_t x, int32_t y) const
+{
+    HWND hWnd = (HWND)GetHandle();
+    HDC hdc = GetDC(hWnd);
+    if (hdc == NULL)
+        return false;
+
+    // PrintWindow 总是从客户区原点绘制，所以位图包含 (0, 0) 到区域右下角
+    int32_t width = x + buffer.Width;
+    int32_t height = y + buffer.Height;
+    BITMAPINFO bmi = {};
+    bmi.bmiHeader.biSize = sizeof(bmi.bmiHeader);
+    bmi.bmiHeader.biWidth = width;
+    bmi.bmiHeader.biHeight = -height;
+    bmi.bmiHeader.biPlanes = 1;
+    bmi.bmiHeader.biBitCount = 32;
+    bmi.bmiHeader.biCompression = BI_RGB;
+
+    void* bits = nullptr;
+    HDC memDC = CreateCompatibleDC(hdc);
+    HBITMAP bitmap = CreateDIBSection(memDC, &bmi, DIB_RGB_COLORS, &bits, NULL, 0);
+    bool ok = false;
+    if (bitmap != NULL)
+    {
+        auto old = SelectObject(memDC, bitmap);
+
+        // PW_RENDERFULLCONTENT 能读到被遮挡的窗口和 DirectX 内容，失败时退回到从屏幕复制
+        ok = PrintWindow(hWnd, memDC, PW_CLIENTONLY | PW_RENDERFULLCONTENT) || BitBlt(memDC, x, y, buffer.Width, buffer.Height, hdc, x, y, SRCCOPY);
+        if (ok)
+        {
+            GdiFlush();
+
+            // GDI 不写 alpha 通道
+            for (int32_t row = 0; row < buffer.Height; row++)
+            {
+                auto src = (const uint32_t*)bits + (size_t)(y + row) * width + x;
+                auto dst = (uint32_t*)(buffer.Data + (size_t)row * buffer.Stride);
+                for (int32_t col = 0; col < buffer.Width; col++)
+                    dst[col] = src[col] | 0xff000000;
+            }
+        }
+
+        SelectObject(memDC, old);
+        DeleteObject(bitmap);
+    }
+
+    DeleteDC(memDC);
+    ReleaseDC(hWnd, hdc);
+    return ok;
+}
+
+bool Window::IsOccluded() const
+{
+    // Win32 不报告窗口是否被其他窗口遮挡，只能检测被 DWM 隐藏（如位于其他虚拟桌面）
+    DWORD cloaked = 0;
+    if (FAILED(DwmGetWindowAttribute((HWND)GetHandle(), DWMWA_CLOAKED, &cloaked, sizeof(cloaked))))
+        return false;
+
+    return cloaked != 0;
+}
+
+void Window::SetFocusImpl(bool value)
 {
     if (value)
         ::SetFocus((HWND)GetHandle());
@@ -647,7 +985,7 @@ std::string Window::GetTitle() const
     return FromNative(buffer);
 }
 
-void Window::SetTitle(const std::string& value)
+void Window::SetTitleImpl(const std::string& value)
 {
     SetWindowText((HWND)GetHandle(), ToNative(value));
 }
@@ -660,9 +998,10 @@ Rect<float> Window::GetRect() const
     return {r.left / dpi, r.top / dpi, (r.right - r.left) / dpi, (r.bottom - r.top) / dpi};
 }
 
-void Window::SetRect(const Rect<float>& value)
+void Window::SetRectImpl(const Rect<float>& value)
 {
-    if (GetWindowState() == WindowState::Maximized)
+    auto state = GetWindowState();
+    if (state == WindowState::Maximized || state == WindowState::Fullscreen)
         return;
 
     float dpi = GetDpiForWindow((HWND)GetHandle()) / (float)USER_DEFAULT_SCREEN_DPI;
@@ -677,9 +1016,10 @@ Size<float> Window::GetClientSize() const
     return {(r.right - r.left) / dpi, (r.bottom - r.top) / dpi};
 }
 
-void Window::SetClientSize(const Size<float>& value)
+void Window::SetClientSizeImpl(const Size<float>& value)
 {
-    if (GetWindowState() == WindowState::Maximized)
+    auto state = GetWindowState();
+    if (state == WindowState::Maximized || state == WindowState::Fullscreen)
         return;
 
     float dpi = GetDpiForWindow((HWND)GetHandle()) / (float)USER_DEFAULT_SCREEN_DPI;
@@ -688,7 +1028,7 @@ void Window::SetClientSize(const Size<float>& value)
     auto rect = GetRect();
     rect.Width = (r.right - r.left) / dpi;
     rect.Height = (r.bottom - r.top) / dpi;
-    SetRect(rect);
+    SetRectImpl(rect);
 }
 
 WindowState Window::GetWindowState() const
@@ -696,14 +1036,74 @@ WindowState Window::GetWindowState() const
     if (IsIconic((HWND)GetHandle()))
         return WindowState::Minimized;
 
+    if (nativeWindow != nullptr && nativeWindow->fullscreen)
+        return WindowState::Fullscreen;
+
     if (IsZoomed((HWND)GetHandle()))
         return WindowState::Maximized;
 
     return WindowState::Normal;
 }
 
-void Window::SetWindowState(WindowState state)
+// 覆盖整个显示器的无边框窗口会被 DWM 直接翻转到屏幕，不再经过合成
+static void EnterFullscreen(NativeWindow* native, FullscreenMode mode)
+{
+    HWND hWnd = native->hWnd;
+    MONITORINFOEXW info = {};
+    info.cbSize = sizeof(info);
+    if (!GetMonitorInfoW(MonitorFromWindow(hWnd, MONITOR_DEFAULTTONEAREST), &info))
+        return;
+
+    if (!native->fullscreen)
+    {
+        native->savedStyle = GetWindowLongPtrW(hWnd, GWL_STYLE);
+        native->savedExStyle = GetWindowLongPtrW(hWnd, GWL_EXSTYLE);
+        GetWindowPlacement(hWnd, &native->placement);
+    }
+
+    native->fullscreen = true;
+    native->exclusive = mode == FullscreenMode::Exclusive;
+
+    // 最大化、最小化的窗口先还原，否则系统会按原来的状态继续调整位置
+    if (IsIconic(hWnd) || IsZoomed(hWnd))
+        ShowWindow(hWnd, SW_RESTORE);
+
+    native->ReleaseDisplay();
+    if (mode == FullscreenMode::Exclusive)
+    {
+        // 以当前模式设置 CDS_FULLSCREEN，窗口销毁或退出全屏时系统还原显示模式
+        DEVMODEW dm = {};
+        dm.dmSize = sizeof(dm);
+        if (EnumDisplaySettingsW(info.szDevice, ENUM_CURRENT_SETTINGS, &dm) && ChangeDisplaySettingsExW(info.szDevice, &dm, NULL, CDS_FULLSCREEN, NULL) == DISP_CHANGE_SUCCESSFUL)
+            wcscpy_s(native->device, info.szDevice);
+    }
+
+    SetWindowLongPtrW(hWnd, GWL_STYLE, (native->savedStyle & ~(WS_OVERLAPPEDWINDOW | WS_MAXIMIZE | WS_MINIMIZE)) | WS_POPUP);
+    SetWindowLongPtrW(hWnd, GWL_EXSTYLE, native->savedExStyle & ~(WS_EX_DLGMODALFRAME | WS_EX_WINDOWEDGE | WS_EX_CLIENTEDGE | WS_EX_STATICEDGE));
+
+    const RECT& r = info.rcMonitor;
+    SetWindowPos(hWnd, native->exclusive ? HWND_TOPMOST : HWND_NOTOPMOST, r.left, r.top, r.right - r.left, r.bottom - r.top, SWP_FRAMECHANGED | SWP_NOOWNERZORDER | SWP_SHOWWINDOW);
+}
+
+static void ExitFullscreen(NativeWindow* native)
+{
+    HWND hWnd = native->hWnd;
+    native->ReleaseDisplay();
+    native->fullscreen = false;
+    native->exclusive = false;
+
+    SetWindowLongPtrW(hWnd, GWL_STYLE, native->savedStyle);
+    SetWindowLongPtrW(hWnd, GWL_EXSTYLE, native->savedExStyle);
+    SetWindowPos(hWnd, (native->savedExStyle & WS_EX_TOPMOST) ? HWND_TOPMOST : HWND_NOTOPMOST, 0, 0, 0, 0, SWP_NOMOVE | SWP_NOSIZE | SWP_NOACTIVATE | SWP_FRAMECHANGED | SWP_NOOWNERZORDER);
+    SetWindowPlacement(hWnd, &native->placement);
+}
+
+void Window::SetWindowStateImpl(WindowState state)
 {
+    // 全屏时最小化保留全屏状态，还原时回到全屏
+    if (nativeWindow->fullscreen && state != WindowState::Fullscreen && state != WindowState::Minimized)
+        ExitFullscreen(nativeWindow);
+
     switch (state)
     {
         case WindowState::Normal:
@@ -715,7 +1115,13 @@ void Window::SetWindowState(WindowState state)
         case WindowState::Maximized:
             ShowWindow((HWND)GetHandle(), SW_MAXIMIZE);
             break;
+        case WindowState::Fullscreen:
+            EnterFullscreen(nativeWindow, fullscreenMode);
+            break;
     }
+
+    // 大小不变时没有 WM_SIZE
+    NotifyWindowState(this);
 }
 
 bool Window::GetTopMost() const
@@ -723,7 +1129,7 @@ bool Window::GetTopMost() const
     return (GetWindowLong((HWND)GetHandle(), GWL_EXSTYLE) & WS_EX_TOPMOST) != 0;
 }
 
-void Window::SetTopMost(bool value)
+void Window::SetTopMostImpl(bool value)
 {
     SetWindowPos((HWND)GetHandle(), value ? HWND_TOPMOST : HWND_NOTOPMOST, 0, 0, 0, 0, SWP_NOSIZE | SWP_NOMOVE | SWP_NOACTIVATE);
 }
@@ -736,31 +1142,33 @@ float Window::GetTransparency() const
     return std::clamp(alpha / (float)0xFF, 0.f, 1.f);
 }
 
-void Window::SetTransparency(float alpha)
+void Window::SetTransparencyImpl(float alpha)
 {
     SetLayeredWindowAttributes((HWND)GetHandle(), 0, (BYTE)(alpha * 0xFF), LWA_ALPHA);
 }
 
-void Window::MoveToCenter()
+void Window::MoveToCenterImpl()
 {
     if (GetWindowState() != WindowState::Normal)
         return;
 
-    auto r = GetRect();
-
-    RECT rectWorkArea;
-    SystemParametersInfo(SPI_GETWORKAREA, 0, &rectWorkArea, SPIF_SENDCHANGE); // 获取屏幕客户区大小
-
-    float dpi = GetDpiForWindow((HWND)GetHandle()) / (float)USER_DEFAULT_SCREEN_DPI;
+    // 使用缓存的显示器信息，稳定状态下不需要查询系统
+    auto& monitors = Application::Current()->GetMonitors();
+    auto it = std::find_if(monitors.begin(), monitors.end(), [](const Monitor& m)
+                           { return m.Primary; });
+    if (it == monitors.end())
+        return;
 
-    r.X = ((rectWorkArea.right - rectWorkArea.left) / dpi - r.Width) / 2;
-    r.Y = ((rectWorkArea.bottom - rectWorkArea.top) / dpi - r.Height) / 2;
+    auto r = GetRect();
+    r.X = it->WorkArea.X + (it->WorkArea.Width - r.Width) / 2;
+    r.Y = it->WorkArea.Y + (it->WorkArea.Height - r.Height) / 2;
 
-    SetRect(r);
+    SetRectImpl(r);
 }
 
 Window::~Window()
 {
-    Close();
+    CloseImpl();
+    SetEventQueue(nullptr);
 }
 #endif
\ No newline at end of file
@@ -1,23 +1,180 @@
 ﻿#include "Window.h"
 #include "Application.h"
+#include "EventQueue.h"
+#include "Watchdog.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <vector>
 
 using namespace tk;
 
-void RegisterWindow(Window* win, const std::function<void()>& updater);
+void RegisterWindow(Window* win);
 void UnRegisterWindow(Window* win);
+void RescheduleWindow(Window* win, bool request);
+std::pmr::memory_resource* GetListenerResource();
+std::pmr::memory_resource* GetCommandResource();
+void RecordFirstEvent();
+LoopContext* GetLoopContext();
+FrameStatsRecorder* GetLoopStats(LoopContext* context);
+void WakeLoopContext(LoopContext* context);
+
+static thread_local std::vector<Window*> textInputWindows;
+static thread_local bool firstEventSeen = false;
+static thread_local std::vector<uint8_t> captureScratch;
+
+// CaptureChanges 比较的块大小（像素）
+constexpr int32_t CAPTURE_TILE_SIZE = 64;
+
+// 从池中分配，稳态下跨线程调用不再访问系统堆
+struct Window::Command
+{
+    explicit Command(CommandType type) : type(type) {}
+    Command(CommandType type, bool flag) : type(type), flag(flag) {}
+    virtual ~Command() = default;
+
+    static void* operator new(size_t size)
+    {
+        return GetCommandResource()->allocate(size, alignof(std::max_align_t));
+    }
+
+    static void operator delete(void* p, size_t size)
+    {
+        GetCommandResource()->deallocate(p, size, alignof(std::max_align_t));
+    }
+
+    Command* next = nullptr;
+    CommandType type;
+    bool flag = false;
+    float number = 0;
+    int32_t integer = 0;
+    Rect<float> rect = {};
+};
+
+// 只有标题命令携带字符串
+struct Window::TitleCommand : Command
+{
+    explicit TitleCommand(const std::string& text) : Command(CommandType::Title), text(text) {}
+
+    std::string text;
+};
+
+Window::CommandQueue::~CommandQueue()
+{
+    auto cmd = head.exchange(nullptr);
+    while (cmd != nullptr)
+    {
+        auto next = cmd->next;
+        delete cmd;
+        cmd = next;
+    }
+}
 
 Window::Window()
+    : listeners(GetListenerResource())
+    , owner(GetLoopContext())
+    , loopStats(GetLoopStats(owner))
+{
+    RegisterWindow(this);
+}
+
+namespace tk
+{
+// 由平台实现在窗口状态可能改变时调用，状态确实改变时才发送 StateChanged
+void NotifyWindowState(Window* win)
+{
+    if (win->nativeWindow == nullptr)
+        return;
+
+    auto state = win->GetWindowState();
+    if (state == win->windowState)
+        return;
+
+    win->windowState = state;
+
+    Event e;
+    e.type = EventType::StateChanged;
+    DispatchEvent(win, &e);
+}
+
+// 由平台实现在焦点变化时调用
+void PublishWindowSnapshot(Window* win)
+{
+    win->PublishSnapshot(false);
+}
+
+// 由平台的 DispatchEvent 在分发之前调用，事件可能在 EventQueue 的消费线程处理，快照只能在这里更新
+void PublishWindowSnapshot(Window* win, const Event* e)
+{
+    switch (e->type)
+    {
+        case EventType::Create:
+        case EventType::Resize:
+        case EventType::DpiChanged:
+        case EventType::VisibleChanged:
+        case EventType::StateChanged:
+            win->PublishSnapshot(false);
+            break;
+        case EventType::Closed:
+            // 与快照一样在进入 EventQueue 之前标记，所属线程之后执行的异步回调都能看到
+            win->lifetime->store(false);
+            win->PublishSnapshot(true);
+            break;
+        default:
+            break;
+    }
+}
+
+// 由 Application 在窗口到期时调用
+void UpdateWindow(Window* win, std::chrono::steady_clock::duration delta)
 {
-    RegisterWindow(this, [this]()
-                   { this->OnUpdate(); });
+    win->updateDelta = delta;
+    WatchdogScope scope(win, EventType::None);
+
+    auto begin = std::chrono::steady_clock::now();
+    win->OnUpdate();
+    auto time = std::chrono::steady_clock::now() - begin;
+    win->frameStats.AddOnUpdateTime(time);
+    win->frameStats.RecordFrame(time);
+    if (time >= (std::min)(win->updateInterval, std::chrono::steady_clock::duration(UPDATE_INTERVAL)))
+        win->frameStats.AddMissedFrames(1);
 }
+} // namespace tk
 
 void Window::OnEvent(Event* e)
 {
+    WatchdogScope scope(this, e->type);
+
+    if (!firstEventSeen && e->type != EventType::Create)
+    {
+        firstEventSeen = true;
+        RecordFirstEvent();
+    }
+
+    frameStats.AddEvent();
+    if (loopStats != nullptr)
+        loopStats->AddEvent();
+
+    // 回调可能销毁窗口本身，每次回调之后检查本帧，失效时直接返回
+    struct FrameGuard
+    {
+        DispatchFrames& frames;
+        DispatchFrame frame;
+
+        ~FrameGuard()
+        {
+            if (frame.alive)
+                frames.top = frame.outer;
+        }
+    } guard{dispatchFrames, {dispatchFrames.top}};
+    dispatchFrames.top = &guard.frame;
+    const auto& frame = guard.frame;
+
     switch (e->type)
     {
         case EventType::Closed:
             UnRegisterWindow(this);
+            textInputWindows.erase(std::remove(textInputWindows.begin(), textInputWindows.end(), this), textInputWindows.end());
             this->OnClose();
             break;
         case EventType::Closing:
@@ -26,29 +183,649 @@ void Window::OnEvent(Event* e)
         case EventType::VisibleChanged:
             this->OnVisibleChanged();
             break;
+        case EventType::StateChanged:
+            // 关联事件队列时在消费线程中，调度表属于所属线程
+            if (IsOwnerThread())
+                RescheduleWindow(this, false);
+            else
+                PostCommand(new Command(CommandType::Reschedule));
+            this->OnStateChanged();
+            break;
     }
+    if (!frame.alive)
+        return;
+
+    auto& typed = handlers[(size_t)e->type];
+    if (typed.empty() && listeners.empty())
+        return;
+
+    // 原地遍历，不再为每个事件复制监听器；分发期间新增的监听器不参与本次分发，移除的延迟到分发结束后释放
+    dispatching++;
+    for (size_t i = 0, count = typed.size(); i < count; i++)
+    {
+        if (!typed[i].removed)
+            typed[i](this, e);
+        if (!frame.alive)
+            return;
+    }
+
+    if (!listeners.empty())
+    {
+        auto last = std::prev(listeners.end());
+        for (auto it = listeners.begin();; ++it)
+        {
+            if (!it->removed)
+                it->callback(this, e);
+            if (!frame.alive)
+                return;
+
+            if (it == last)
+                break;
+        }
+    }
+    dispatching--;
+
+    if (dispatching == 0 && listenersDirty)
+    {
+        listenersDirty = false;
+        listeners.remove_if([](const Listener& l)
+                            { return l.removed; });
+        for (auto&& list : handlers)
+        {
+            list.erase(std::remove_if(list.begin(), list.end(), [](const TypedHandler& h)
+                                      { return h.removed; }),
+                       list.end());
+        }
+    }
+
+    if (dispatching == 0 && !pendingHandlers.empty())
+    {
+        for (auto&& it : pendingHandlers)
+        {
+            if (!it.second.removed)
+                handlers[(size_t)it.first].push_back(std::move(it.second));
+        }
+        pendingHandlers.clear();
+    }
+}
+
+// 只能在所属线程调用，是快照唯一的写者；内容不变时不发布
+void Window::PublishSnapshot(bool closed)
+{
+    auto current = snapshot.Load();
+    auto next = current;
+    if (closed || nativeWindow == nullptr)
+    {
+        // 保留最后的大小
+        next.Visible = false;
+        next.Focused = false;
+    }
+    else
+    {
+        next.ClientSize = GetClientSize();
+        next.DpiScale = GetDpiScale();
+        next.PixelSize = {(int32_t)std::lround(next.ClientSize.Width * next.DpiScale), (int32_t)std::lround(next.ClientSize.Height * next.DpiScale)};
+        next.State = GetWindowState();
+        next.Visible = IsVisible();
+        next.Focused = GetFocus();
+    }
+
+    if (next.ClientSize == current.ClientSize && next.PixelSize == current.PixelSize && next.DpiScale == current.DpiScale &&
+        next.State == current.State && next.Visible == current.Visible && next.Focused == current.Focused)
+        return;
+
+    next.Generation = current.Generation + 1;
+    snapshot.Store(next);
+}
+
+void Window::SetUpdatePolicy(const UpdatePolicy& policy)
+{
+    updatePolicy = policy;
+    RescheduleWindow(this, false);
+}
+
+void Window::SetUpdateInterval(std::chrono::steady_clock::duration interval)
+{
+    updateInterval = (std::max)(interval, std::chrono::steady_clock::duration::zero());
+    RescheduleWindow(this, false);
+}
+
+void Window::RequestUpdate()
+{
+    if (IsOwnerThread())
+        return RescheduleWindow(this, true);
+
+    PostCommand(new Command(CommandType::Update));
+}
+
+std::chrono::steady_clock::duration Window::GetEffectiveUpdateInterval() const
+{
+    const auto& policy = updatePolicy;
+    if (policy.Minimized == UpdateMode::Normal && policy.Hidden == UpdateMode::Normal && policy.Occluded == UpdateMode::Normal && policy.Unfocused == UpdateMode::Normal)
+        return updateInterval;
+
+    if (nativeWindow == nullptr)
+        return updateInterval;
+
+    // 依次检查，已经暂停时不再查询剩余的状态
+    auto mode = UpdateMode::Normal;
+    auto apply = [&mode](UpdateMode value, auto&& condition)
+    {
+        if (mode != UpdateMode::Suspended && value > mode && condition())
+            mode = value;
+    };
+    apply(policy.Minimized, [this]()
+          { return GetWindowState() == WindowState::Minimized; });
+    apply(policy.Hidden, [this]()
+          { return !IsVisible(); });
+    apply(policy.Occluded, [this]()
+          { return IsOccluded(); });
+    apply(policy.Unfocused, [this]()
+          { return !GetFocus(); });
+
+    switch (mode)
+    {
+        case UpdateMode::Throttled:
+            return (std::max)(std::chrono::steady_clock::duration(policy.ThrottleInterval), updateInterval);
+        case UpdateMode::Suspended:
+            return std::chrono::steady_clock::duration::max();
+        default:
+            return updateInterval;
+    }
+}
+
+bool Window::CaptureToBuffer(const CaptureBuffer& buffer, const Rect<float>& rect)
+{
+    if (nativeWindow == nullptr || buffer.Data == nullptr || buffer.Width <= 0 || buffer.Height <= 0 || buffer.Stride < buffer.Width * 4)
+        return false;
+
+    float scale = GetDpiScale();
+    auto client = GetClientSize();
+    int32_t clientWidth = (int32_t)std::lround(client.Width * scale);
+    int32_t clientHeight = (int32_t)std::lround(client.Height * scale);
+    int32_t x = std::clamp((int32_t)std::lround(rect.X * scale), 0, clientWidth);
+    int32_t y = std::clamp((int32_t)std::lround(rect.Y * scale), 0, clientHeight);
+    int32_t width = (std::min)({(int32_t)std::lround(rect.Width * scale), clientWidth - x, buffer.Width});
+    int32_t height = (std::min)({(int32_t)std::lround(rect.Height * scale), clientHeight - y, buffer.Height});
+    if (width <= 0 || height <= 0)
+        return false;
+
+    return CaptureImpl({buffer.Data, width, height, buffer.Stride}, x, y);
+}
+
+bool Window::CaptureToBuffer(const CaptureBuffer& buffer)
+{
+    return CaptureToBuffer(buffer, {{0, 0}, GetClientSize()});
+}
+
+bool Window::CaptureChanges(const CaptureBuffer& buffer, std::vector<Rect<int32_t>>& dirty)
+{
+    dirty.clear();
+    if (nativeWindow == nullptr || buffer.Data == nullptr || buffer.Stride < buffer.Width * 4)
+        return false;
+
+    float scale = GetDpiScale();
+    auto client = GetClientSize();
+    int32_t width = (std::min)((int32_t)std::lround(client.Width * scale), buffer.Width);
+    int32_t height = (std::min)((int32_t)std::lround(client.Height * scale), buffer.Height);
+    if (width <= 0 || height <= 0)
+        return false;
+
+    // 系统不提供其他进程（如 DWM）绘制造成的脏区域，先截到临时缓冲区再按块比较
+    int32_t stride = width * 4;
+    captureScratch.resize((size_t)stride * height);
+    if (!CaptureImpl({captureScratch.data(), width, height, stride}, 0, 0))
+        return false;
+
+    for (int32_t top = 0; top < height; top += CAPTURE_TILE_SIZE)
+    {
+        int32_t rows = (std::min)(CAPTURE_TILE_SIZE, height - top);
+        for (int32_t left = 0; left < width; left += CAPTURE_TILE_SIZE)
+        {
+            int32_t bytes = (std::min)(CAPTURE_TILE_SIZE, width - left) * 4;
+            auto src = captureScratch.data() + (size_t)top * stride + left * 4;
+            auto dst = buffer.Data + (size_t)top * buffer.Stride + left * 4;
+
+            bool changed = false;
+            for (int32_t row = 0; row < rows && !changed; row++)
+                changed = memcmp(src + (size_t)row * stride, dst + (size_t)row * buffer.Stride, bytes) != 0;
+            if (!changed)
+                continue;
+
+            for (int32_t row = 0; row < rows; row++)
+                memcpy(dst + (size_t)row * buffer.Stride, src + (size_t)row * stride, bytes);
+
+            // 同一行相邻的块合并为一个区域
+            if (!dirty.empty() && dirty.back().Y == top && dirty.back().X + dirty.back().Width == left)
+                dirty.back().Width += bytes / 4;
+            else
+                dirty.push_back({left, top, bytes / 4, rows});
+        }
+    }
+
+    return true;
+}
+
+void Window::SetEventQueue(EventQueue* queue)
+{
+    if (eventQueue == queue)
+        return;
+
+    // 在各自的分发权内修改 eventQueue，消费线程的回调读取时不会竞争
+    if (eventQueue != nullptr)
+        eventQueue->Detach(this);
+
+    if (queue != nullptr)
+        queue->Attach(this);
+}
+
+uint32_t Window::AddHandler(EventType type, TypedHandler&& handler)
+{
+    EventQueue::DispatchScope scope(eventQueue);
+    handler.id = ++event_id;
+    auto id = handler.id;
 
-    auto listeners = this->listeners;
-    for (auto&& f : listeners)
+    // 分发期间向正在遍历的数组添加会导致重新分配，先放入待添加列表
+    if (dispatching > 0)
+        pendingHandlers.emplace_back(type, std::move(handler));
+    else
+        handlers[(size_t)type].push_back(std::move(handler));
+
+    if (subscribers[(size_t)type]++ == 0)
+        RefreshEventMask();
+    return id;
+}
+
+void Window::SetBaseEventMask(uint32_t mask)
+{
+    EventQueue::DispatchScope scope(eventQueue);
+    baseEventMask = mask & EVENT_MASK_ALL;
+    RefreshEventMask();
+}
+
+void Window::RefreshEventMask()
+{
+    uint32_t mask = baseEventMask;
+    if (genericListeners > 0)
+        mask = EVENT_MASK_ALL;
+
+    for (size_t i = 0; i < (size_t)EventType::Count; i++)
     {
-        f.second(this, e);
+        if (subscribers[i] > 0)
+            mask |= EventMask((EventType)i);
     }
+
+    if (mask == eventMask.load(std::memory_order_relaxed))
+        return;
+
+    eventMask.store(mask, std::memory_order_relaxed);
+    if (!IsOwnerThread())
+        PostCommand(new Command(CommandType::EventMask));
+    else if (nativeWindow != nullptr)
+        UpdateEventMaskImpl();
 }
 
+// 关联事件队列时监听器也在消费线程中遍历，修改前先取得分发权
 uint32_t Window::AddEventListener(const std::function<void(Window*, Event*)>& callback)
 {
+    EventQueue::DispatchScope scope(eventQueue);
     event_id++;
-    this->listeners.emplace(event_id, callback);
+    this->listeners.push_back(Listener{event_id, false, callback});
+    if (genericListeners++ == 0)
+        RefreshEventMask();
     return event_id;
 }
 
 bool Window::RemoveEventListener(uint32_t id)
 {
-    auto it = this->listeners.find(id);
-    if (it != this->listeners.end())
+    EventQueue::DispatchScope scope(eventQueue);
+    for (size_t i = 0; i < (size_t)EventType::Count; i++)
     {
-        this->listeners.erase(it);
+        auto& list = handlers[i];
+        auto h = std::find_if(list.begin(), list.end(), [id](const TypedHandler& h)
+                              { return h.id == id && !h.removed; });
+        if (h == list.end())
+            continue;
+
+        if (dispatching > 0)
+        {
+            h->removed = true;
+            listenersDirty = true;
+        }
+        else
+        {
+            list.erase(h);
+        }
+
+        if (--subscribers[i] == 0)
+            RefreshEventMask();
         return true;
     }
-    return false;
+
+    for (auto&& it : pendingHandlers)
+    {
+        if (it.second.id == id && !it.second.removed)
+        {
+            it.second.removed = true;
+            if (--subscribers[(size_t)it.first] == 0)
+                RefreshEventMask();
+            return true;
+        }
+    }
+
+    auto it = std::find_if(listeners.begin(), listeners.end(), [id](const Listener& l)
+                           { return l.id == id && !l.removed; });
+    if (it == listeners.end())
+        return false;
+
+    if (dispatching > 0)
+    {
+        it->removed = true;
+        listenersDirty = true;
+    }
+    else
+    {
+        listeners.erase(it);
+    }
+
+    if (--genericListeners == 0)
+        RefreshEventMask();
+    return true;
+}
+
+namespace tk
+{
+void AppendTextInput(Window* win, std::string_view text)
+{
+    if (text.empty())
+        return;
+
+    if (win->pendingText.empty())
+        textInputWindows.push_back(win);
+
+    win->pendingText.append(text);
+}
+
+void FlushTextInput(Window* win)
+{
+    if (win->pendingText.empty())
+        return;
+
+    // 分发期间可能再次进入消息循环，先移出缓冲区，结束后再放回以复用容量
+    std::string text = std::move(win->pendingText);
+    win->pendingText.clear();
+
+    TextInputEvent e;
+    e.type = EventType::TextInput;
+    e.Text = text;
+    DispatchEvent(win, &e);
+
+    if (win->pendingText.empty())
+    {
+        text.clear();
+        win->pendingText.swap(text);
+    }
+}
+} // namespace tk
+
+void FlushAllTextInput()
+{
+    for (size_t i = 0; i < textInputWindows.size(); i++)
+        FlushTextInput(textInputWindows[i]);
+
+    textInputWindows.clear();
+}
+
+bool Window::IsOwnerThread() const
+{
+    return owner == nullptr || owner == GetLoopContext();
+}
+
+void Window::PostCommand(Command* cmd)
+{
+    auto head = commands.head.load(std::memory_order_relaxed);
+    do
+    {
+        cmd->next = head;
+    } while (!commands.head.compare_exchange_weak(head, cmd, std::memory_order_release, std::memory_order_relaxed));
+
+    // 只有栈从空变为非空时才需要唤醒所属线程
+    if (head == nullptr)
+        WakeLoopContext(owner);
+}
+
+namespace tk
+{
+// 在窗口所属线程调用，同类命令只执行最后一条
+void ReplayWindowCommands(Window* win)
+{
+    auto cmd = win->commands.head.exchange(nullptr, std::memory_order_acquire);
+    if (cmd == nullptr)
+        return;
+
+    Window::Command* list = nullptr;
+    Window::Command* last[(size_t)Window::CommandType::Count] = {};
+    while (cmd != nullptr)
+    {
+        auto next = cmd->next;
+        cmd->next = list;
+        list = cmd;
+        cmd = next;
+    }
+    for (cmd = list; cmd != nullptr; cmd = cmd->next)
+        last[(size_t)cmd->type] = cmd;
+
+    bool close = false;
+    for (cmd = list; cmd != nullptr;)
+    {
+        auto next = cmd->next;
+        if (last[(size_t)cmd->type] == cmd)
+        {
+            switch (cmd->type)
+            {
+                case Window::CommandType::Visible:
+                    cmd->flag ? win->ShowImpl() : win->HideImpl();
+                    break;
+                case Window::CommandType::Close:
+                    close = true;
+                    break;
+                case Window::CommandType::MousePosition:
+                    win->SetMousePositionImpl(cmd->rect.Position);
+                    break;
+                case Window::CommandType::Cursor:
+                    win->SetCursorImpl((Cursor)cmd->integer);
+                    break;
+                case Window::CommandType::MouseCapture:
+                    win->SetMouseCaptureImpl(cmd->flag);
+                    break;
+                case Window::CommandType::Focus:
+                    win->SetFocusImpl(cmd->flag);
+                    break;
+                case Window::CommandType::Title:
+                    win->SetTitleImpl(static_cast<Window::TitleCommand*>(cmd)->text);
+                    break;
+                case Window::CommandType::Rect:
+                    win->SetRectImpl(cmd->rect);
+                    break;
+                case Window::CommandType::ClientSize:
+                    win->SetClientSizeImpl(cmd->rect.Size);
+                    break;
+                case Window::CommandType::WindowState:
+                    win->SetWindowStateImpl((WindowState)cmd->integer);
+                    break;
+                case Window::CommandType::TopMost:
+                    win->SetTopMostImpl(cmd->flag);
+                    break;
+                case Window::CommandType::Transparency:
+                    win->SetTransparencyImpl(cmd->number);
+                    break;
+                case Window::CommandType::Style:
+                    win->SetStyle(cmd->integer);
+                    break;
+                case Window::CommandType::MoveToCenter:
+                    win->MoveToCenterImpl();
+                    break;
+                case Window::CommandType::Update:
+                    RescheduleWindow(win, true);
+                    break;
+                case Window::CommandType::Reschedule:
+                    RescheduleWindow(win, false);
+                    break;
+                case Window::CommandType::EventMask:
+                    if (win->nativeWindow != nullptr)
+                        win->UpdateEventMaskImpl();
+                    break;
+                default:
+                    break;
+            }
+        }
+        delete cmd;
+        cmd = next;
+    }
+
+    // 关闭可能销毁窗口，放在最后执行
+    if (close)
+        win->CloseImpl();
+}
+} // namespace tk
+
+void Window::Show()
+{
+    if (IsOwnerThread())
+        return ShowImpl();
+
+    PostCommand(new Command(CommandType::Visible, true));
+}
+
+void Window::Hide()
+{
+    if (IsOwnerThread())
+        return HideImpl();
+
+    PostCommand(new Command(CommandType::Visible, false));
+}
+
+void Window::Close()
+{
+    if (IsOwnerThread())
+        return CloseImpl();
+
+    PostCommand(new Command(CommandType::Close));
+}
+
+void Window::SetMousePosition(const Point<float>& p)
+{
+    if (IsOwnerThread())
+        return SetMousePositionImpl(p);
+
+    auto cmd = new Command(CommandType::MousePosition);
+    cmd->rect.Position = p;
+    PostCommand(cmd);
+}
+
+void Window::SetCursor(const Cursor& cur)
+{
+    if (IsOwnerThread())
+        return SetCursorImpl(cur);
+
+    auto cmd = new Command(CommandType::Cursor);
+    cmd->integer = (int32_t)cur;
+    PostCommand(cmd);
+}
+
+void Window::SetMouseCapture(bool value)
+{
+    if (IsOwnerThread())
+        return SetMouseCaptureImpl(value);
+
+    PostCommand(new Command(CommandType::MouseCapture, value));
+}
+
+void Window::SetFocus(bool value)
+{
+    if (IsOwnerThread())
+        return SetFocusImpl(value);
+
+    PostCommand(new Command(CommandType::Focus, value));
+}
+
+void Window::SetTitle(const std::string& value)
+{
+    if (IsOwnerThread())
+        return SetTitleImpl(value);
+
+    PostCommand(new TitleCommand(value));
+}
+
+void Window::SetRect(const Rect<float>& value)
+{
+    if (IsOwnerThread())
+        return SetRectImpl(value);
+
+    auto cmd = new Command(CommandType::Rect);
+    cmd->rect = value;
+    PostCommand(cmd);
+}
+
+void Window::SetClientSize(const Size<float>& value)
+{
+    if (IsOwnerThread())
+        return SetClientSizeImpl(value);
+
+    auto cmd = new Command(CommandType::ClientSize);
+    cmd->rect.Size = value;
+    PostCommand(cmd);
+}
+
+void Window::SetWindowState(WindowState state)
+{
+    if (IsOwnerThread())
+        return SetWindowStateImpl(state);
+
+    auto cmd = new Command(CommandType::WindowState);
+    cmd->integer = (int32_t)state;
+    PostCommand(cmd);
+}
+
+void Window::SetTopMost(bool value)
+{
+    if (IsOwnerThread())
+        return SetTopMostImpl(value);
+
+    PostCommand(new Command(CommandType::TopMost, value));
+}
+
+void Window::SetTransparency(float alpha)
+{
+    if (IsOwnerThread())
+        return SetTransparencyImpl(alpha);
+
+    auto cmd = new Command(CommandType::Transparency);
+    cmd->number = alpha;
+    PostCommand(cmd);
+}
+
+void Window::SetStyle(int32_t value)
+{
+    if (!IsOwnerThread())
+    {
+        auto cmd = new Command(CommandType::Style);
+        cmd->integer = value;
+        PostCommand(cmd);
+        return;
+    }
+
+    if (style != value)
+    {
+        style = value;
+        OnStyleChanged();
+    }
+}
+
+void Window::MoveToCenter()
+{
+    if (IsOwnerThread())
+        return MoveToCenterImpl();
+
+    PostCommand(new Command(CommandType::MoveToCenter));
 }
\ No newline at end of file
@@ -3,10 +3,21 @@
 #include <Windows.h>
 #endif
 
+#include <atomic>
 #include <string>
+#include <string_view>
 #include <functional>
+#include <list>
 #include <map>
+#include <memory>
+#include <memory_resource>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
 #include <stdint.h>
+#include "FrameStats.h"
+#include "SeqLock.h"
 
 namespace tk
 {
@@ -94,7 +105,7 @@ struct Rect
             T Width;
             T Height;
         };
-        Size<T> Size;
+        tk::Size<T> Size;
     };
 };
 
@@ -102,7 +113,18 @@ struct Rect
 #pragma warning(default : 4201) // 使用了非标准扩展: 无名称的结构/联合
 #endif
 
+// 由调用者分配的像素缓冲区，格式为 BGRA8、预乘 alpha，行从上到下排列
+struct CaptureBuffer
+{
+    uint8_t* Data = nullptr;
+    int32_t Width = 0;  // 像素
+    int32_t Height = 0; // 像素
+    int32_t Stride = 0; // 每行字节数，不小于 Width * 4
+};
+
 struct NativeWindow;
+struct LoopContext;
+class EventQueue;
 
 enum class EventType
 {
@@ -113,8 +135,11 @@ enum class EventType
     Resize,
     DpiChanged,
     VisibleChanged,
+    StateChanged, // GetWindowState 的结果发生变化
+    MonitorsChanged,
 
-    Input,
+    TextInput,
+    TextComposition,
 
     KeyDown,
     KeyUp,
@@ -127,9 +152,21 @@ enum class EventType
     MouseMove,
     MouseWheel,
     MouseClick,
-    MouseDoubleClick
+    MouseDoubleClick,
+
+    Count
 };
 
+static_assert((uint32_t)EventType::Count <= 32, "event mask requires at most 32 event types");
+
+constexpr uint32_t EventMask(EventType type)
+{
+    return 1u << (uint32_t)type;
+}
+
+constexpr uint32_t EVENT_MASK_ALL = (1u << (uint32_t)EventType::Count) - 1;
+constexpr uint32_t EVENT_MASK_MOTION = EventMask(EventType::MouseMove) | EventMask(EventType::MouseEnter) | EventMask(EventType::MouseExit);
+
 struct Event
 {
     EventType type = EventType::None;
@@ -292,16 +329,114 @@ struct KeyEvent : public Event
     Keys Key;
 };
 
-struct InputEvent : public Event
+// 一帧内输入的文本会合并为一个 UTF-8 串，只在分发期间有效
+struct TextInputEvent : public Event
+{
+    std::string_view Text;
+};
+
+// 输入法预编辑文本，Text 为空表示组合结束；Cursor 为 Text 中的字节偏移
+struct TextCompositionEvent : public Event
+{
+    std::string_view Text;
+    int32_t Cursor;
+};
+
+// 事件类型对应的事件数据，Window::On 在编译期检查
+template <EventType T>
+struct EventPayload
+{
+    using Type = Event;
+};
+
+template <>
+struct EventPayload<EventType::TextInput>
+{
+    using Type = TextInputEvent;
+};
+
+template <>
+struct EventPayload<EventType::TextComposition>
+{
+    using Type = TextCompositionEvent;
+};
+
+template <>
+struct EventPayload<EventType::KeyDown>
+{
+    using Type = KeyEvent;
+};
+
+template <>
+struct EventPayload<EventType::KeyUp>
+{
+    using Type = KeyEvent;
+};
+
+template <>
+struct EventPayload<EventType::KeyPress>
+{
+    using Type = KeyEvent;
+};
+
+template <>
+struct EventPayload<EventType::MouseDown>
+{
+    using Type = MouseButtonEvent;
+};
+
+template <>
+struct EventPayload<EventType::MouseUp>
+{
+    using Type = MouseButtonEvent;
+};
+
+template <>
+struct EventPayload<EventType::MouseClick>
 {
-    uint32_t Char;
+    using Type = MouseButtonEvent;
 };
 
+template <>
+struct EventPayload<EventType::MouseDoubleClick>
+{
+    using Type = MouseButtonEvent;
+};
+
+template <>
+struct EventPayload<EventType::MouseWheel>
+{
+    using Type = MouseWheelEvent;
+};
+
+template <EventType T>
+using EventPayloadType = typename EventPayload<T>::Type;
+
 enum class WindowState
 {
     Normal,
     Minimized,
-    Maximized
+    Maximized,
+    Fullscreen
+};
+
+// 进入全屏的方式，两种都覆盖窗口所在的整个显示器，退出时还原之前的位置和状态
+enum class FullscreenMode
+{
+    Borderless, // 无边框窗口：Windows 上由 DWM 直接翻转到屏幕，macOS 上使用系统全屏
+    Exclusive   // 独占显示器：Windows 上置顶并锁定显示模式，失去焦点时最小化；macOS 上捕获显示器
+};
+
+// 窗口的几何和状态，由所属线程在观察到变化时发布，渲染线程等任意线程都可以无锁读取
+struct WindowSnapshot
+{
+    Size<float> ClientSize = {0, 0}; // 逻辑单位，与 GetClientSize 一致
+    Size<int32_t> PixelSize = {0, 0};
+    float DpiScale = 1;
+    WindowState State = WindowState::Normal;
+    bool Visible = false;
+    bool Focused = false;
+    uint64_t Generation = 0; // 每次发布递增，创建前为 0
 };
 
 constexpr int32_t WINDOW_NOTITLE = 1 << 0;
@@ -309,10 +444,40 @@ constexpr int32_t WINDOW_BUTTON_MIN = 1 << 1;
 constexpr int32_t WINDOW_BUTTON_MAX = 1 << 2;
 constexpr int32_t WINDOW_BUTTON_CLOSE = 1 << 3;
 constexpr int32_t WINDOW_RESIZABLE = 1 << 4;
+constexpr int32_t WINDOW_POOLED = 1 << 5; // 关闭后放入 WindowPool 复用，适合提示框、菜单等频繁出现的窗口
+
+// 默认的 OnUpdate 间隔
+constexpr auto UPDATE_INTERVAL = std::chrono::milliseconds(33);
+
+enum class UpdateMode
+{
+    Normal,
+    Throttled, // 按 UpdatePolicy::ThrottleInterval 更新
+    Suspended  // 不调用 OnUpdate，条件解除后立即恢复
+};
+
+// 窗口处于各状态时的 OnUpdate 频率，同时满足多个条件时取最低的频率
+struct UpdatePolicy
+{
+    UpdateMode Minimized = UpdateMode::Normal;
+    UpdateMode Hidden = UpdateMode::Normal;
+    UpdateMode Occluded = UpdateMode::Normal;
+    UpdateMode Unfocused = UpdateMode::Normal;
+    std::chrono::milliseconds ThrottleInterval = std::chrono::milliseconds(250);
+};
 
 class Window
 {
     friend void DispatchEvent(Window* win, Event* e);
+    friend void AppendTextInput(Window* win, std::string_view text);
+    friend void FlushTextInput(Window* win);
+    friend void ReplayWindowCommands(Window* win);
+    friend void UpdateWindow(Window* win, std::chrono::steady_clock::duration delta);
+    friend bool RecycleWindow(Window* win);
+    friend void NotifyWindowState(Window* win);
+    friend void PublishWindowSnapshot(Window* win);
+    friend void PublishWindowSnapshot(Window* win, const Event* e);
+    friend class EventQueue;
 
 #ifdef _WIN32
     friend LRESULT WINAPI WndProc(HWND hWnd, UINT msg, WPARAM wParam, LPARAM lParam);
@@ -340,8 +505,29 @@ protected:
 
     virtual void OnVisibleChanged() {}
 
+    virtual void OnStateChanged() {}
+
     virtual void OnStyleChanged();
 
+    // 平台实现，只能在窗口所属的线程调用；公开的同名方法在其他线程调用时会转为命令，在所属线程的下一次循环中执行
+    void ShowImpl();
+    void HideImpl();
+    void CloseImpl();
+    void SetMousePositionImpl(const Point<float>& p);
+    void SetCursorImpl(const Cursor& cur);
+    void SetMouseCaptureImpl(bool value);
+    void SetFocusImpl(bool value);
+    void SetTitleImpl(const std::string& value);
+    void SetRectImpl(const Rect<float>& value);
+    void SetClientSizeImpl(const Size<float>& value);
+    void SetWindowStateImpl(WindowState state);
+    void SetTopMostImpl(bool value);
+    void SetTransparencyImpl(float alpha);
+    void MoveToCenterImpl();
+    bool CaptureImpl(const CaptureBuffer& buffer, int32_t x, int32_t y) const; // 像素坐标，大小由 buffer 决定
+    bool RecycleImpl();                                                        // 隐藏并放回 WindowPool，返回 false 时应正常销毁
+    void UpdateEventMaskImpl();                                                // 按 eventMask 调整向系统订阅的事件
+
 public:
     Window();
 
@@ -350,6 +536,75 @@ public:
     uint32_t AddEventListener(const std::function<void(Window*, Event*)>& callback);
     bool RemoveEventListener(uint32_t id);
 
+    // 关联后除 Create、Closing、Closed 外的事件都由 queue 的消费线程分发，传入 nullptr 恢复同步分发；只能在所属线程调用
+    void SetEventQueue(EventQueue* queue);
+    EventQueue* GetEventQueue() const { return eventQueue; }
+
+    // 无论有没有监听器都分发的事件，默认为 EVENT_MASK_ALL；不在 OnEvent 中处理鼠标移动的窗口可以去掉 EVENT_MASK_MOTION 减少事件。只能在所属线程调用
+    // 实际的掩码还包括 On<T> 注册了处理器的类型，AddEventListener 注册的监听器会订阅所有事件
+    void SetBaseEventMask(uint32_t mask);
+    uint32_t GetBaseEventMask() const { return baseEventMask; }
+    uint32_t GetEventMask() const { return eventMask.load(std::memory_order_relaxed); }
+
+    bool IsSubscribed(EventType type) const { return (GetEventMask() & EventMask(type)) != 0; }
+
+    // 只能在所属线程调用
+    void SetUpdatePolicy(const UpdatePolicy& policy);
+    const UpdatePolicy& GetUpdatePolicy() const { return updatePolicy; }
+
+    // OnUpdate 的间隔，默认 UPDATE_INTERVAL；duration::max() 表示只在 RequestUpdate 后更新。只能在所属线程调用
+    void SetUpdateInterval(std::chrono::steady_clock::duration interval);
+    std::chrono::steady_clock::duration GetUpdateInterval() const { return updateInterval; }
+
+    // 按更新策略和当前状态计算的实际间隔，暂停时返回 duration::max()
+    std::chrono::steady_clock::duration GetEffectiveUpdateInterval() const;
+
+    // 在下一次循环中调用 OnUpdate，可以在任意线程调用；窗口被策略暂停时推迟到恢复后
+    void RequestUpdate();
+
+    // 距上一次 OnUpdate 的实际时间，第一次为 0；在 OnUpdate 中使用
+    std::chrono::steady_clock::duration GetUpdateDelta() const { return updateDelta; }
+
+    // 窗口被完全遮挡或被系统隐藏（macOS 的遮挡状态、Windows 的 DWM cloaking）
+    bool IsOccluded() const;
+
+    // 把客户区中 rect 的内容读到 buffer 的左上角，超出客户区或 buffer 的部分被裁掉；只能在所属线程调用
+    bool CaptureToBuffer(const CaptureBuffer& buffer, const Rect<float>& rect);
+    bool CaptureToBuffer(const CaptureBuffer& buffer);
+
+    // 连续截取时使用：buffer 保存上一次的结果，只写入发生变化的块，dirty 返回这些块的像素区域
+    bool CaptureChanges(const CaptureBuffer& buffer, std::vector<Rect<int32_t>>& dirty);
+
+    // 最近一次发布的快照，可以在任意线程调用；Resize 等事件分发之前快照已经更新
+    WindowSnapshot GetSnapshot() const { return snapshot.Load(); }
+
+    // 与 GetSnapshot().Generation 相同，不复制快照，适合每帧轮询是否有变化
+    uint64_t GetSnapshotGeneration() const { return snapshot.GetSequence() / 2 - 1; }
+
+    // 窗口关闭后标记变为 false，销毁后失效，可以在任意线程检查；用于丢弃与窗口相关的异步结果
+    std::weak_ptr<const std::atomic<bool>> GetLifetime() const { return lifetime; }
+
+    // OnUpdate 耗时和事件数，可以在任意线程调用
+    FrameStats GetFrameStats() const { return frameStats.Snapshot(); }
+
+    // 只接收 T 类型的事件，回调以 f(Window*, E&) 直接调用；小对象保存在处理器内部，不做堆分配
+    // 返回值同样用 RemoveEventListener 移除
+    template <typename E, EventType T, typename F>
+    uint32_t On(F&& f)
+    {
+        static_assert(T != EventType::None && T != EventType::Count, "invalid event type");
+        static_assert(std::is_same_v<E, EventPayloadType<T>>, "event payload does not match the event type");
+        static_assert(std::is_invocable_v<std::decay_t<F>&, Window*, E&>, "handler must be callable as f(Window*, E&)");
+
+        return AddHandler(T, TypedHandler::Make<E>(0, std::forward<F>(f)));
+    }
+
+    template <EventType T, typename F>
+    uint32_t On(F&& f)
+    {
+        return On<EventPayloadType<T>, T>(std::forward<F>(f));
+    }
+
     void Show();
 
     void Hide();
@@ -390,6 +645,10 @@ public:
     WindowState GetWindowState() const;
     void SetWindowState(WindowState);
 
+    // 之后进入全屏时使用的方式，默认 Borderless；只能在所属线程调用
+    void SetFullscreenMode(FullscreenMode mode) { fullscreenMode = mode; }
+    FullscreenMode GetFullscreenMode() const { return fullscreenMode; }
+
     bool GetTopMost() const;
     void SetTopMost(bool);
 
@@ -397,14 +656,7 @@ public:
     void SetTransparency(float alpha);
 
     int32_t GetStyle() const { return style; }
-    void SetStyle(int32_t value)
-    {
-        if (style != value)
-        {
-            style = value;
-            OnStyleChanged();
-        }
-    }
+    void SetStyle(int32_t value);
 
     bool HasStyle(int32_t value) { return (style & value) != 0; }
 
@@ -417,9 +669,187 @@ public:
     virtual ~Window();
 
 private:
+    enum class CommandType : uint8_t
+    {
+        Visible,
+        Close,
+        MousePosition,
+        Cursor,
+        MouseCapture,
+        Focus,
+        Title,
+        Rect,
+        ClientSize,
+        WindowState,
+        TopMost,
+        Transparency,
+        Style,
+        MoveToCenter,
+        Update,
+        Reschedule,
+        EventMask,
+        Count
+    };
+
+    struct Command;
+    struct TitleCommand;
+
+    // 多生产者单消费者的无锁命令栈，回放时反转为提交顺序
+    struct CommandQueue
+    {
+        std::atomic<Command*> head = nullptr;
+
+        ~CommandQueue();
+    };
+
+    bool IsOwnerThread() const;
+    void PostCommand(Command* cmd);
+
+    struct Listener
+    {
+        uint32_t id;
+        bool removed;
+        std::function<void(Window*, Event*)> callback;
+    };
+
+    // 不经过 std::function 的处理器：不超过 INLINE_SIZE 的可调用对象直接存放在内部
+    class TypedHandler
+    {
+    public:
+        static constexpr size_t INLINE_SIZE = 4 * sizeof(void*);
+
+        template <typename E, typename F>
+        static TypedHandler Make(uint32_t id, F&& f)
+        {
+            using Fn = std::decay_t<F>;
+            TypedHandler h;
+            h.id = id;
+            if constexpr (sizeof(Fn) <= INLINE_SIZE && alignof(Fn) <= alignof(std::max_align_t) && std::is_nothrow_move_constructible_v<Fn>)
+            {
+                new (h.storage) Fn(std::forward<F>(f));
+                h.invoke = [](void* p, Window* win, Event* e)
+                { (*static_cast<Fn*>(p))(win, *static_cast<E*>(e)); };
+                h.manage = [](void* dst, void* src)
+                {
+                    if (src != nullptr)
+                        new (dst) Fn(std::move(*static_cast<Fn*>(src)));
+                    static_cast<Fn*>(src != nullptr ? src : dst)->~Fn();
+                };
+            }
+            else
+            {
+                *reinterpret_cast<Fn**>(h.storage) = new Fn(std::forward<F>(f));
+                h.invoke = [](void* p, Window* win, Event* e)
+                { (**static_cast<Fn**>(p))(win, *static_cast<E*>(e)); };
+                h.manage = [](void* dst, void* src)
+                {
+                    if (src != nullptr)
+                        *static_cast<Fn**>(dst) = *static_cast<Fn**>(src);
+                    else
+                        delete *static_cast<Fn**>(dst);
+                };
+            }
+            return h;
+        }
+
+        TypedHandler() = default;
+
+        TypedHandler(TypedHandler&& other) noexcept
+        {
+            *this = std::move(other);
+        }
+
+        TypedHandler& operator=(TypedHandler&& other) noexcept
+        {
+            if (this != &other)
+            {
+                Reset();
+                id = other.id;
+                removed = other.removed;
+                invoke = other.invoke;
+                manage = other.manage;
+                if (manage != nullptr)
+                    manage(storage, other.storage);
+                other.invoke = nullptr;
+                other.manage = nullptr;
+            }
+            return *this;
+        }
+
+        ~TypedHandler()
+        {
+            Reset();
+        }
+
+        void operator()(Window* win, Event* e)
+        {
+            invoke(storage, win, e);
+        }
+
+        uint32_t id = 0;
+        bool removed = false;
+
+    private:
+        void Reset()
+        {
+            if (manage != nullptr)
+                manage(storage, nullptr);
+            invoke = nullptr;
+            manage = nullptr;
+        }
+
+        alignas(std::max_align_t) unsigned char storage[INLINE_SIZE];
+        void (*invoke)(void*, Window*, Event*) = nullptr;
+        void (*manage)(void*, void*) = nullptr;
+    };
+
+    // 未结束的分发，窗口在回调中被销毁时全部标记失效，分发据此立即返回而不再访问成员
+    struct DispatchFrame
+    {
+        DispatchFrame* outer = nullptr;
+        bool alive = true;
+    };
+
+    struct DispatchFrames
+    {
+        DispatchFrame* top = nullptr;
+
+        ~DispatchFrames()
+        {
+            for (auto frame = top; frame != nullptr; frame = frame->outer)
+                frame->alive = false;
+        }
+    };
+
+    uint32_t AddHandler(EventType type, TypedHandler&& handler); // 分配并返回 id
+    void RefreshEventMask();
+    void PublishSnapshot(bool closed);
+
     NativeWindow* nativeWindow = nullptr;
     int32_t style = WINDOW_RESIZABLE | WINDOW_BUTTON_MIN | WINDOW_BUTTON_MAX | WINDOW_BUTTON_CLOSE;
     uint32_t event_id = 0;
-    std::map<uint32_t, std::function<void(Window*, Event*)>> listeners;
+    uint32_t dispatching = 0;
+    DispatchFrames dispatchFrames;
+    bool listenersDirty = false;
+    std::pmr::list<Listener> listeners;
+    std::vector<TypedHandler> handlers[(size_t)EventType::Count];
+    std::vector<std::pair<EventType, TypedHandler>> pendingHandlers; // 分发期间新增的处理器
+    uint32_t subscribers[(size_t)EventType::Count] = {};            // 各类型未移除的处理器数量，包括待添加的
+    uint32_t genericListeners = 0;
+    uint32_t baseEventMask = EVENT_MASK_ALL;
+    std::atomic<uint32_t> eventMask = EVENT_MASK_ALL; // 关联事件队列时消费线程的回调也会修改
+    std::string pendingText;
+    LoopContext* owner = nullptr;
+    CommandQueue commands;
+    EventQueue* eventQueue = nullptr;
+    FrameStatsRecorder frameStats;
+    FrameStatsRecorder* loopStats = nullptr;
+    SeqLock<WindowSnapshot> snapshot;
+    std::shared_ptr<std::atomic<bool>> lifetime = std::make_shared<std::atomic<bool>>(true);
+    UpdatePolicy updatePolicy;
+    WindowState windowState = WindowState::Normal; // 最近一次发送 StateChanged 时的状态
+    FullscreenMode fullscreenMode = FullscreenMode::Borderless;
+    std::chrono::steady_clock::duration updateInterval = UPDATE_INTERVAL;
+    std::chrono::steady_clock::duration updateDelta{};
 };
 } // namespace tk
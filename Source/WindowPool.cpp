@@ -0,0 +1,136 @@
+#include <algorithm>
+#include <atomic>
+#include <vector>
+#include "WindowPool.h"
+#include "Application.h"
+
+using namespace tk;
+
+using Clock = std::chrono::steady_clock;
+
+namespace tk
+{
+struct NativeWindow;
+}
+
+extern void DestroyPooledWindow(NativeWindow* native);
+
+struct PooledWindow
+{
+    NativeWindow* native;
+    int32_t style;
+    Clock::time_point released;
+};
+
+// 原生窗口只能在创建它的线程使用，所以每个线程各有一个池
+struct WindowPoolStorage
+{
+    std::vector<PooledWindow> windows; // 按放入的时间排列
+    uint32_t timer = 0;
+
+    ~WindowPoolStorage()
+    {
+        for (auto&& it : windows)
+            DestroyPooledWindow(it.native);
+    }
+};
+
+static std::atomic<size_t> windowPoolCapacity = 8;
+static std::atomic<Clock::rep> windowPoolIdleTimeout = std::chrono::duration_cast<Clock::duration>(std::chrono::seconds(30)).count();
+static thread_local WindowPoolStorage windowPool;
+
+static void TrimIdleWindows()
+{
+    auto& windows = windowPool.windows;
+    auto deadline = Clock::now() - Clock::duration(windowPoolIdleTimeout.load(std::memory_order_relaxed));
+    auto end = std::find_if(windows.begin(), windows.end(), [deadline](const PooledWindow& it)
+                            { return it.released > deadline; });
+
+    std::vector<PooledWindow> expired(windows.begin(), end);
+    windows.erase(windows.begin(), end);
+    for (auto&& it : expired)
+        DestroyPooledWindow(it.native);
+}
+
+static void ScheduleTrim()
+{
+    auto app = Application::Current();
+    if (windowPool.timer != 0 || windowPool.windows.empty() || app == nullptr)
+        return;
+
+    windowPool.timer = app->SetTimeout(Clock::duration(windowPoolIdleTimeout.load(std::memory_order_relaxed)), []()
+                                       {
+        windowPool.timer = 0;
+        TrimIdleWindows();
+        ScheduleTrim(); });
+}
+
+// 由后端在创建带 WINDOW_POOLED 样式的窗口时调用，没有可复用的窗口时返回 nullptr
+NativeWindow* AcquirePooledWindow(int32_t style)
+{
+    auto& windows = windowPool.windows;
+    for (auto it = windows.rbegin(); it != windows.rend(); ++it)
+    {
+        if (it->style == style)
+        {
+            auto native = it->native;
+            windows.erase(std::next(it).base());
+            return native;
+        }
+    }
+
+    return nullptr;
+}
+
+// 由后端在窗口关闭时调用，窗口已经隐藏并与 Window 解除关联
+void ReleasePooledWindow(NativeWindow* native, int32_t style)
+{
+    auto& windows = windowPool.windows;
+    windows.push_back({native, style, Clock::now()});
+
+    size_t capacity = windowPoolCapacity.load(std::memory_order_relaxed);
+    while (windows.size() > capacity)
+    {
+        auto oldest = windows.front().native;
+        windows.erase(windows.begin());
+        DestroyPooledWindow(oldest);
+    }
+
+    ScheduleTrim();
+}
+
+void WindowPool::SetCapacity(size_t count)
+{
+    windowPoolCapacity = count;
+
+    auto& windows = windowPool.windows;
+    while (windows.size() > count)
+    {
+        auto oldest = windows.front().native;
+        windows.erase(windows.begin());
+        DestroyPooledWindow(oldest);
+    }
+}
+
+size_t WindowPool::GetCapacity()
+{
+    return windowPoolCapacity.load();
+}
+
+void WindowPool::SetIdleTimeout(Clock::duration timeout)
+{
+    windowPoolIdleTimeout = (std::max)(timeout, Clock::duration::zero()).count();
+}
+
+void WindowPool::Clear()
+{
+    std::vector<PooledWindow> windows;
+    windows.swap(windowPool.windows);
+    for (auto&& it : windows)
+        DestroyPooledWindow(it.native);
+}
+
+size_t WindowPool::GetCount()
+{
+    return windowPool.windows.size();
+}
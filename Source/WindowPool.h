@@ -0,0 +1,26 @@
+#pragma once
+#include <chrono>
+#include <stddef.h>
+#include <stdint.h>
+
+namespace tk
+{
+// 缓存关闭后的原生窗口：带 WINDOW_POOLED 样式的窗口关闭时隐藏并放入当前线程的池中，
+// 下次创建样式相同的窗口时直接复用，省去创建原生窗口和初始化样式的开销
+class WindowPool
+{
+public:
+    // 每个线程最多缓存的窗口数，默认 8；超出时销毁最早放入的窗口，设为 0 会清空缓存
+    static void SetCapacity(size_t count);
+    static size_t GetCapacity();
+
+    // 超过这个时间未被复用的窗口会被销毁，默认 30 秒
+    static void SetIdleTimeout(std::chrono::steady_clock::duration timeout);
+
+    // 销毁当前线程缓存的所有窗口
+    static void Clear();
+
+    // 当前线程缓存的窗口数
+    static size_t GetCount();
+};
+} // namespace tk
@@ -0,0 +1,108 @@
+#include "Window.h"
+#include "Application.h"
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+using namespace tk;
+
+// 统计所有经过全局 operator new 的分配，包括不经过库内部内存资源的 std::function、std::vector 等
+static std::atomic<uint64_t> allocations{0};
+
+void* operator new(std::size_t size)
+{
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    if (auto p = std::malloc(size == 0 ? 1 : size))
+        return p;
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size)
+{
+    return operator new(size);
+}
+
+void operator delete(void* p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete[](void* p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept
+{
+    std::free(p);
+}
+
+void operator delete[](void* p, std::size_t) noexcept
+{
+    std::free(p);
+}
+
+constexpr int WARMUP_FRAMES = 30; // 跳过创建窗口、第一次布局等一次性的分配
+constexpr int MEASURED_FRAMES = 120;
+
+class AllocationWindow : public Window
+{
+public:
+    explicit AllocationWindow(Application* app) : app(app) {}
+
+    virtual bool Create() override
+    {
+        return CreateImpl(nullptr, "AllocationTest", {100, 100, 320, 240});
+    }
+
+    int frames = 0;
+    uint64_t measured = 0;
+    AllocationStats stats = {};
+
+protected:
+    virtual void OnUpdate() override
+    {
+        frames++;
+        if (frames == WARMUP_FRAMES)
+        {
+            start = allocations.load(std::memory_order_relaxed);
+            stats = app->GetAllocationStats();
+        }
+        else if (frames == WARMUP_FRAMES + MEASURED_FRAMES)
+        {
+            measured = allocations.load(std::memory_order_relaxed) - start;
+            stats.Total = app->GetAllocationStats().Total - stats.Total;
+            app->Exit();
+        }
+    }
+
+private:
+    Application* app;
+    uint64_t start = 0;
+};
+
+// 空闲的窗口稳定运行后，每帧不应再有任何堆分配
+int main()
+{
+    Application app;
+
+    AllocationWindow win(&app);
+    if (!win.Create())
+    {
+        std::printf("failed to create window\n");
+        return 1;
+    }
+    app.Run(&win);
+
+    if (win.frames < WARMUP_FRAMES + MEASURED_FRAMES)
+    {
+        std::printf("loop exited after %d frames\n", win.frames);
+        return 1;
+    }
+
+    std::printf("%llu allocations in %d idle frames (%llu through library resources)\n",
+                (unsigned long long)win.measured, MEASURED_FRAMES, (unsigned long long)win.stats.Total);
+    return win.measured == 0 ? 0 : 1;
+}
@@ -0,0 +1,112 @@
+#include <linux/input.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+#include "Gamepad.h"
+
+using namespace tk;
+
+// GamepadEvdevReader 不经过后端线程，不需要发布
+void GamepadPublish([[maybe_unused]] int32_t index, [[maybe_unused]] const GamepadState& state)
+{
+}
+
+static int failures = 0;
+
+#define CHECK(expr)                                                  \
+    do                                                               \
+    {                                                                \
+        if (!(expr))                                                 \
+        {                                                            \
+            fprintf(stderr, "%s:%d: %s\n", __FILE__, __LINE__, #expr); \
+            failures++;                                              \
+        }                                                            \
+    } while (0)
+
+static input_event Make(uint16_t type, uint16_t code, int32_t value)
+{
+    input_event ev = {};
+    ev.type = type;
+    ev.code = code;
+    ev.value = value;
+    return ev;
+}
+
+static void Write(int fd, const std::vector<input_event>& events)
+{
+    [[maybe_unused]] auto n = write(fd, events.data(), events.size() * sizeof(input_event));
+}
+
+static bool Near(float a, float b)
+{
+    return std::fabs(a - b) < 1e-3f;
+}
+
+int main()
+{
+    int fds[2];
+    if (pipe2(fds, O_NONBLOCK) != 0)
+        return 1;
+
+    GamepadEvdevReader reader(fds[0]);
+    auto& state = reader.GetState();
+
+    // 按下和松开，SYN_REPORT 之前不生效
+    Write(fds[1], {Make(EV_KEY, BTN_A, 1)});
+    CHECK(reader.Read());
+    CHECK(!state.IsPressed(Keys::GamepadA));
+    Write(fds[1], {Make(EV_SYN, SYN_REPORT, 0)});
+    CHECK(reader.Read());
+    CHECK(state.IsPressed(Keys::GamepadA));
+    CHECK(state.PacketNumber == 1);
+
+    Write(fds[1], {Make(EV_KEY, BTN_A, 0), Make(EV_KEY, BTN_START, 1), Make(EV_SYN, SYN_REPORT, 0)});
+    CHECK(reader.Read());
+    CHECK(!state.IsPressed(Keys::GamepadA));
+    CHECK(state.IsPressed(Keys::GamepadStart));
+
+    // 轴按默认范围归一化，Y 轴翻转为向上为正；方向键来自 HAT
+    Write(fds[1], {Make(EV_ABS, ABS_X, 32767), Make(EV_ABS, ABS_Y, -32768), Make(EV_ABS, ABS_RZ, 255),
+                   Make(EV_ABS, ABS_HAT0X, -1), Make(EV_SYN, SYN_REPORT, 0)});
+    CHECK(reader.Read());
+    CHECK(Near(state.GetAxis(GamepadAxis::LeftX), 1.f));
+    CHECK(Near(state.GetAxis(GamepadAxis::LeftY), 1.f));
+    CHECK(Near(state.GetAxis(GamepadAxis::RightTrigger), 1.f));
+    CHECK(Near(state.GetAxis(GamepadAxis::LeftTrigger), 0.f));
+    CHECK(state.IsPressed(Keys::GamepadLeft));
+    CHECK(!state.IsPressed(Keys::GamepadRight));
+
+    // 事件被拆到两次 read() 中
+    auto split = Make(EV_KEY, BTN_B, 1);
+    auto bytes = (const char*)&split;
+    [[maybe_unused]] auto n = write(fds[1], bytes, 7);
+    CHECK(reader.Read());
+    n = write(fds[1], bytes + 7, sizeof(split) - 7);
+    Write(fds[1], {Make(EV_SYN, SYN_REPORT, 0)});
+    CHECK(reader.Read());
+    CHECK(state.IsPressed(Keys::GamepadB));
+
+    // SYN_DROPPED 之后到下一个 SYN_REPORT 的事件被丢弃；管道无法重新查询设备，保留之前的状态
+    auto packet = state.PacketNumber;
+    Write(fds[1], {Make(EV_SYN, SYN_DROPPED, 0), Make(EV_KEY, BTN_X, 1), Make(EV_ABS, ABS_X, -32768), Make(EV_SYN, SYN_REPORT, 0)});
+    CHECK(reader.Read());
+    CHECK(!state.IsPressed(Keys::GamepadX));
+    CHECK(Near(state.GetAxis(GamepadAxis::LeftX), 1.f));
+    CHECK(state.PacketNumber == packet + 1);
+
+    Write(fds[1], {Make(EV_KEY, BTN_X, 1), Make(EV_SYN, SYN_REPORT, 0)});
+    CHECK(reader.Read());
+    CHECK(state.IsPressed(Keys::GamepadX));
+
+    // 没有数据时不是错误，写端关闭后返回 false
+    CHECK(reader.Read());
+    close(fds[1]);
+    CHECK(!reader.Read());
+    close(fds[0]);
+
+    if (failures == 0)
+        printf("GamepadEvdevTest passed\n");
+    return failures == 0 ? 0 : 1;
+}